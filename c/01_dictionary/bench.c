@@ -0,0 +1,165 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "dict.c"
+#include "oa_dict.h"
+
+/* K&R dict.c against oa_dict.c at 1K to 10M keys: install, lookup of present
+ * and of absent keys and, oa_dict only, remove. Times are ns per operation.
+ *
+ * Usage: bench.out [max keys, default 10000000] [max keys for dict.c,
+ * default 100000]. dict.c has 101 chains whatever the key count, so its
+ * cost per operation grows linearly, a million keys take minutes. */
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* splitmix64, so that keys are spread like real identifiers and not in a
+ * sequence that happens to suit one hash */
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/* keys: n NUL-terminated keys in one buffer, "k" + a random number, or "m"
+ * + one for keys that are never installed */
+static char **make_keys(size_t n, char prefix, char **storage)
+{
+    const size_t max_len = 22; /* prefix, 20 digits, '\0' */
+    char **keys = malloc(n * sizeof(*keys));
+    char *p = *storage = malloc(n * max_len);
+    if (keys == NULL || p == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = p;
+        p += snprintf(p, max_len, "%c%" PRIu64, prefix, mix(i)) + 1;
+    }
+    return keys;
+}
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "check failed: %s\n", what);
+        exit(1);
+    }
+}
+
+static void bench_kr(size_t n, char **keys, char **missing)
+{
+    /* dict.c has one global table and never frees, start from an empty one */
+    memset(hashtab, 0, sizeof(hashtab));
+    double start = now_ns();
+    for (size_t i = 0; i < n; ++i)
+        install(keys[i], keys[i]);
+    double installed = now_ns();
+    size_t found = 0;
+    for (size_t i = 0; i < n; ++i)
+        found += lookup(keys[i]) != NULL;
+    double looked_up = now_ns();
+    for (size_t i = 0; i < n; ++i)
+        found += lookup(missing[i]) != NULL;
+    double missed = now_ns();
+    check(found == n, "dict.c lookup");
+    printf("%10zu %-8s %10.1f %10.1f %10.1f %10s\n", n, "dict.c", (installed - start) / n,
+           (looked_up - installed) / n, (missed - looked_up) / n, "-");
+}
+
+static void bench_oa(size_t n, char **keys, char **missing)
+{
+    struct oa_dict d;
+    check(oa_dict_init(&d) == 0, "oa_dict_init");
+    double start = now_ns();
+    for (size_t i = 0; i < n; ++i)
+        oa_install(&d, keys[i], keys[i]);
+    double installed = now_ns();
+    size_t found = 0;
+    for (size_t i = 0; i < n; ++i)
+        found += oa_lookup(&d, keys[i]) != NULL;
+    double looked_up = now_ns();
+    for (size_t i = 0; i < n; ++i)
+        found += oa_lookup(&d, missing[i]) != NULL;
+    double missed = now_ns();
+    check(found == n && d.count == n, "oa_lookup");
+    /* Remove every other key, then all of them */
+    size_t removed = 0;
+    for (size_t i = 0; i < n; i += 2)
+        removed += oa_remove(&d, keys[i]);
+    for (size_t i = 0; i < n; ++i)
+        removed += oa_remove(&d, keys[i]);
+    double removed_at = now_ns();
+    check(removed == n && d.count == 0, "oa_remove");
+    printf("%10zu %-8s %10.1f %10.1f %10.1f %10.1f\n", n, "oa_dict", (installed - start) / n,
+           (looked_up - installed) / n, (missed - looked_up) / n, (removed_at - missed) / (n + (n + 1) / 2));
+    oa_dict_free(&d);
+}
+
+/* The same behaviour as main.c, plus growth and removal */
+static void check_oa(void)
+{
+    struct oa_dict d;
+    check(oa_dict_init(&d) == 0, "oa_dict_init");
+    oa_install(&d, "hello", "world!");
+    oa_install(&d, "foo", "bar");
+    oa_install(&d, "pi", "3.1415926535");
+    check(strcmp(oa_lookup(&d, "foo")->value, "bar") == 0, "foo");
+    struct oa_item *pi = oa_lookup(&d, "pi");
+    oa_install(&d, "foo", "new bar");
+    check(strcmp(oa_lookup(&d, "foo")->value, "new bar") == 0, "new foo");
+    oa_install(&d, "foo", "b");
+    check(strcmp(oa_lookup(&d, "foo")->value, "b") == 0, "shorter foo");
+    check(oa_lookup(&d, "") == NULL, "empty key");
+    oa_install(&d, "", "empty");
+    check(strcmp(oa_lookup(&d, "")->value, "empty") == 0, "empty key");
+    char key[32];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "key %d", i);
+        oa_install(&d, key, key);
+    }
+    check(oa_lookup(&d, "pi") == pi, "items don't move when the table grows");
+    for (int i = 0; i < 1000; i += 3) {
+        snprintf(key, sizeof(key), "key %d", i);
+        check(oa_remove(&d, key) == 1, "remove");
+        check(oa_remove(&d, key) == 0, "remove twice");
+    }
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "key %d", i);
+        struct oa_item *item = oa_lookup(&d, key);
+        check(i % 3 == 0 ? item == NULL : item != NULL && strcmp(item->value, key) == 0, "lookup after remove");
+    }
+    check(d.count == 4 + 1000 - 334, "count");
+    oa_dict_free(&d);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_keys = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    size_t max_kr_keys = argc > 2 ? strtoull(argv[2], NULL, 10) : 100000;
+    check_oa();
+
+    char *key_storage, *missing_storage;
+    char **keys = make_keys(max_keys, 'k', &key_storage);
+    char **missing = make_keys(max_keys, 'm', &missing_storage);
+    printf("%10s %-8s %10s %10s %10s %10s\n", "keys", "dict", "install", "hit", "miss", "remove");
+    for (size_t n = 1000; n <= max_keys; n *= 10) {
+        if (n <= max_kr_keys)
+            bench_kr(n, keys, missing);
+        bench_oa(n, keys, missing);
+    }
+    free(keys);
+    free(key_storage);
+    free(missing);
+    free(missing_storage);
+    return 0;
+}
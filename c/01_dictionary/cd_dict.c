@@ -0,0 +1,98 @@
+#include "cd_dict.h"
+
+#include <sched.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() ((void) 0)
+#endif
+
+static inline struct cd_shard *shard_of(struct cd_dict *d, uint64_t hash)
+{
+    /* Low bits, oa_dict picks slots from the upper half */
+    return &d->shards[hash & (CD_SHARDS - 1)];
+}
+
+int cd_dict_init(struct cd_dict *d)
+{
+    for (size_t i = 0; i < CD_SHARDS; ++i) {
+        struct cd_shard *shard = &d->shards[i];
+        shard->seq = 0;
+        if (oa_dict_init(&shard->dict) != 0) {
+            while (i-- > 0)
+                oa_dict_free(&d->shards[i].dict);
+            return -1;
+        }
+        shard->dict.shared = 1;
+        pthread_mutex_init(&shard->lock, NULL);
+    }
+    return 0;
+}
+
+void cd_dict_free(struct cd_dict *d)
+{
+    for (size_t i = 0; i < CD_SHARDS; ++i) {
+        oa_dict_free(&d->shards[i].dict);
+        pthread_mutex_destroy(&d->shards[i].lock);
+    }
+}
+
+/* Seqlock reader: a lookup that saw the same even count before and after
+ * ran while no writer was active, otherwise it's retried. */
+const struct oa_item *cd_lookup(struct cd_dict *d, const char *s)
+{
+    size_t len = strlen(s);
+    uint64_t hash = oa_hash(s, len);
+    struct cd_shard *shard = shard_of(d, hash);
+    for (unsigned spins = 0;; ++spins) {
+        unsigned begin = __atomic_load_n(&shard->seq, __ATOMIC_ACQUIRE);
+        if (begin & 1) { /* writer active */
+            /* A writer preempted mid-update would otherwise be spun on for
+             * the rest of the time slice */
+            if (spins < 1000)
+                cpu_relax();
+            else
+                sched_yield();
+            continue;
+        }
+        const struct oa_item *item = oa_lookup_hashed(&shard->dict, s, len, hash);
+        /* The table loads above must not move after the re-check */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shard->seq, __ATOMIC_RELAXED) == begin)
+            return item;
+    }
+}
+
+static struct cd_shard *write_begin(struct cd_dict *d, uint64_t hash)
+{
+    struct cd_shard *shard = shard_of(d, hash);
+    pthread_mutex_lock(&shard->lock);
+    __atomic_store_n(&shard->seq, shard->seq + 1, __ATOMIC_RELAXED);
+    /* Odd count visible before any change to the table */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return shard;
+}
+
+static void write_end(struct cd_shard *shard)
+{
+    __atomic_store_n(&shard->seq, shard->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+const struct oa_item *cd_install(struct cd_dict *d, const char *key, const char *value)
+{
+    struct cd_shard *shard = write_begin(d, oa_hash(key, strlen(key)));
+    const struct oa_item *item = oa_install(&shard->dict, key, value);
+    write_end(shard);
+    return item;
+}
+
+int cd_remove(struct cd_dict *d, const char *key)
+{
+    struct cd_shard *shard = write_begin(d, oa_hash(key, strlen(key)));
+    int removed = oa_remove(&shard->dict, key);
+    write_end(shard);
+    return removed;
+}
@@ -0,0 +1,46 @@
+#ifndef CD_DICT_H
+#define CD_DICT_H
+
+#include <pthread.h>
+
+#include "oa_dict.h"
+
+/* Thread-safe dictionary for many readers and few writers, e.g. a
+ * symbol -> metadata table: oa_dict shards, each with a writer mutex and a
+ * sequence count. Lookups take no lock and write no shared memory, they
+ * retry if a writer changed their shard meanwhile (a seqlock), so readers
+ * scale with cores. Writers to different shards run in parallel. */
+
+#define CD_SHARDS 64 /* a power of two */
+
+struct cd_shard {
+    unsigned seq; /* odd while a writer is changing dict */
+    pthread_mutex_t lock; /* writers only */
+    struct oa_dict dict;
+} __attribute__((aligned(64))); /* no false sharing between shards */
+
+struct cd_dict {
+    struct cd_shard shards[CD_SHARDS];
+};
+
+/* cd_dict_init: an empty dictionary, 0 on success, -1 if out of memory */
+int cd_dict_init(struct cd_dict *d);
+
+/* cd_dict_free: frees everything, no other thread may be using d */
+void cd_dict_free(struct cd_dict *d);
+
+/* cd_lookup: look for s in d, NULL if not found. The item is never modified
+ * and stays valid until cd_dict_free(), even if the key is removed or its
+ * value replaced meanwhile. */
+const struct oa_item *cd_lookup(struct cd_dict *d, const char *s);
+
+/* cd_install: put (key, value) in d, NULL if out of memory */
+const struct oa_item *cd_install(struct cd_dict *d, const char *key, const char *value);
+
+/* cd_remove: remove key from d, 1 if it was there, 0 if not */
+int cd_remove(struct cd_dict *d, const char *key);
+
+/* Replaced and removed items are only reclaimed by cd_dict_free(), like
+ * oa_dict, so a table with a steady stream of updates grows in memory. */
+
+#endif /* CD_DICT_H */
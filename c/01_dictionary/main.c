@@ -1,18 +1,153 @@
+#define _GNU_SOURCE
+#include <pthread.h>
 #include <stdio.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "dict.c"
+#include "cd_dict.h"
 
-int main() {
+/* Read scaling at 99 lookups per install: NSYMBOLS symbols, every thread
+ * does OPS_PER_THREAD random operations, from 1 thread up to one per core
+ * (or argv[1] threads). cd_dict against one oa_dict behind a rwlock, whose
+ * readers all write the lock's cache line. */
+
+#define NSYMBOLS 100000
+#define OPS_PER_THREAD 2000000
+#define WRITES_PER_100 1
+
+static char symbols[NSYMBOLS][16];
+
+struct rw_dict {
+    pthread_rwlock_t lock;
+    struct oa_dict dict;
+};
+
+struct worker {
+    pthread_t thread;
+    int cpu;
+    int use_cd;
+    struct cd_dict *cd;
+    struct rw_dict *rw;
+    pthread_barrier_t *start;
+    size_t found;
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void *work(void *arg)
+{
+    struct worker *w = arg;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(w->cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    uint64_t rng = 0x9e3779b97f4a7c15ull * (w->cpu + 1); /* xorshift64 */
+    char value[32];
+    size_t found = 0;
+    pthread_barrier_wait(w->start);
+    for (size_t i = 0; i < OPS_PER_THREAD; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        const char *symbol = symbols[(rng >> 8) % NSYMBOLS];
+        if (rng % 100 < WRITES_PER_100) {
+            snprintf(value, sizeof(value), "px=%zu", i);
+            if (w->use_cd) {
+                cd_install(w->cd, symbol, value);
+            } else {
+                pthread_rwlock_wrlock(&w->rw->lock);
+                oa_install(&w->rw->dict, symbol, value);
+                pthread_rwlock_unlock(&w->rw->lock);
+            }
+        } else if (w->use_cd) {
+            const struct oa_item *item = cd_lookup(w->cd, symbol);
+            found += item != NULL && item->value[0] == 'p';
+        } else {
+            pthread_rwlock_rdlock(&w->rw->lock);
+            const struct oa_item *item = oa_lookup(&w->rw->dict, symbol);
+            found += item != NULL && item->value[0] == 'p';
+            pthread_rwlock_unlock(&w->rw->lock);
+        }
+    }
+    w->found = found;
+    return NULL;
+}
+
+/* run: Mops/s of nthreads threads on one dictionary */
+static double run(int use_cd, int nthreads, int ncpus, struct cd_dict *cd, struct rw_dict *rw)
+{
+    struct worker workers[nthreads];
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, nthreads + 1);
+    for (int t = 0; t < nthreads; ++t) {
+        workers[t] = (struct worker){.cpu = t % ncpus, .use_cd = use_cd, .cd = cd, .rw = rw, .start = &start};
+        pthread_create(&workers[t].thread, NULL, work, &workers[t]);
+    }
+    pthread_barrier_wait(&start);
+    double begin = now_ns();
+    size_t found = 0;
+    for (int t = 0; t < nthreads; ++t) {
+        pthread_join(workers[t].thread, NULL);
+        found += workers[t].found;
+    }
+    double elapsed = now_ns() - begin;
+    pthread_barrier_destroy(&start);
+    if (found == 0) {
+        fprintf(stderr, "no lookup found its symbol\n");
+        exit(1);
+    }
+    return (double) nthreads * OPS_PER_THREAD / elapsed * 1e3;
+}
+
+static void bench_threads(int max_threads)
+{
+    int ncpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (max_threads <= 0)
+        max_threads = ncpus;
+
+    static struct cd_dict cd;
+    struct rw_dict rw;
+    if (cd_dict_init(&cd) != 0 || oa_dict_init(&rw.dict) != 0) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    pthread_rwlock_init(&rw.lock, NULL);
+    for (size_t i = 0; i < NSYMBOLS; ++i) {
+        snprintf(symbols[i], sizeof(symbols[i]), "SYM%zu", i);
+        cd_install(&cd, symbols[i], "px=0");
+        oa_install(&rw.dict, symbols[i], "px=0");
+    }
+
+    printf("\n%d symbols, %d%% installs, %d cores\n", NSYMBOLS, WRITES_PER_100, ncpus);
+    printf("%8s %16s %16s\n", "threads", "rwlock Mops/s", "cd_dict Mops/s");
+    for (int n = 1; n <= max_threads; n = n < max_threads && 2 * n > max_threads ? max_threads : 2 * n)
+        printf("%8d %16.1f %16.1f\n", n, run(0, n, ncpus, &cd, &rw), run(1, n, ncpus, &cd, &rw));
+
+    cd_dict_free(&cd);
+    oa_dict_free(&rw.dict);
+    pthread_rwlock_destroy(&rw.lock);
+}
+
+int main(int argc, char *argv[]) {
     install("hello", "world!");
-    install("foo", "bar");    
+    install("foo", "bar");
     install("pi", "3.1415926535");
 
     printf("%s\n", lookup("hello")->value);
     printf("%s\n", lookup("foo")->value);
-    printf("%s\n", lookup("foo")->value);    
+    printf("%s\n", lookup("foo")->value);
     printf("%s\n", lookup("pi")->value);
     install("foo", "new bar");
     printf("%s\n", lookup("foo")->value);
     printf("%s\n", lookup("foo")->value);
+
+    bench_threads(argc > 1 ? atoi(argv[1]) : 0);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,314 @@
+#include "oa_dict.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Robin Hood hashing: linear probing where an item being inserted takes the
+ * slot of any item that is closer to its own home slot, and continues with
+ * that one instead. Probe lengths stay short and even at a high load factor,
+ * and a lookup can stop as soon as it meets an item closer to home than the
+ * key would be. Removal shifts the following items back one slot
+ * (backward-shift deletion), so there are no tombstones. */
+
+#define OA_INITIAL_SLOTS 16
+#define OA_MAX_LOAD_NUM 7 /* grow at 7/8 full */
+#define OA_MAX_LOAD_DEN 8
+#define OA_CHUNK_SIZE (64 * 1024)
+
+/* hash: wyhash (its short input path, plus the 16-byte loop for longer
+ * keys), about 1 multiply per 8 bytes instead of 1 per byte, and every input
+ * bit reaches the upper half, which picks the slot below */
+
+static const uint64_t wy_secret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+                                      0x4d5a2da51de1aa47ull};
+
+static inline void wy_mum(uint64_t *a, uint64_t *b)
+{
+    __uint128_t r = (__uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+}
+
+static inline uint64_t wy_mix(uint64_t a, uint64_t b)
+{
+    wy_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wy_r8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t wy_r4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t wy_r3(const uint8_t *p, size_t k)
+{
+    return ((uint64_t) p[0] << 16) | ((uint64_t) p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t oa_hash(const char *key, size_t len)
+{
+    const uint8_t *p = (const uint8_t *) key;
+    uint64_t seed = wy_mix(wy_secret[0], wy_secret[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (wy_r4(p) << 32) | wy_r4(p + ((len >> 3) << 2));
+            b = (wy_r4(p + len - 4) << 32) | wy_r4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = wy_r3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        while (i > 16) {
+            seed = wy_mix(wy_r8(p) ^ wy_secret[1], wy_r8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = wy_r8(p + i - 16);
+        b = wy_r8(p + i - 8);
+    }
+    a ^= wy_secret[1];
+    b ^= seed;
+    wy_mum(&a, &b);
+    return wy_mix(a ^ wy_secret[0] ^ len, b ^ wy_secret[1]);
+}
+
+/* arena: items, keys and values are bumped out of 64KB chunks instead of
+ * 3 mallocs per entry, and freed all at once */
+
+struct oa_chunk {
+    struct oa_chunk *next;
+    char data[];
+};
+
+static void *arena_alloc(struct oa_dict *d, size_t size)
+{
+    size = (size + 7) & ~(size_t) 7; /* keeps items 8-byte aligned */
+    if ((size_t) (d->arena_end - d->arena_next) < size) {
+        size_t chunk_size = size > OA_CHUNK_SIZE ? size : OA_CHUNK_SIZE;
+        struct oa_chunk *chunk = malloc(sizeof(*chunk) + chunk_size);
+        if (chunk == NULL)
+            return NULL;
+        chunk->next = d->chunks;
+        d->chunks = chunk;
+        d->arena_next = chunk->data;
+        d->arena_end = chunk->data + chunk_size;
+    }
+    void *p = d->arena_next;
+    d->arena_next += size;
+    return p;
+}
+
+int oa_dict_init(struct oa_dict *d)
+{
+    memset(d, 0, sizeof(*d));
+    d->slots = calloc(OA_INITIAL_SLOTS, sizeof(*d->slots));
+    if (d->slots == NULL)
+        return -1;
+    d->mask = OA_INITIAL_SLOTS - 1;
+    return 0;
+}
+
+void oa_dict_free(struct oa_dict *d)
+{
+    for (struct oa_retired *retired = d->retired; retired != NULL; retired = retired->next)
+        free(retired->slots);
+    struct oa_chunk *chunk = d->chunks;
+    while (chunk != NULL) {
+        struct oa_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(d->slots);
+    memset(d, 0, sizeof(*d));
+}
+
+/* home: the slot a hash wants, from its upper half */
+static inline size_t home(size_t mask, uint64_t hash)
+{
+    return (size_t) (hash >> 32) & mask;
+}
+
+/* distance: how far slot i is from the home slot of hash */
+static inline size_t distance(size_t mask, uint64_t hash, size_t i)
+{
+    return (i - home(mask, hash)) & mask;
+}
+
+/* store: the item last, with release semantics, so that a reader that
+ * loads it also sees the item's contents (see oa_lookup_hashed) */
+static inline void store(struct oa_slot *slot, struct oa_slot in)
+{
+    __atomic_store_n(&slot->hash, in.hash, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->item, in.item, __ATOMIC_RELEASE);
+}
+
+/* find_slot: key's slot, or NULL. The mask is loaded before the slots and
+ * grow() stores them in the opposite order, so that a concurrent reader
+ * never indexes a smaller, older array with a newer mask. */
+static struct oa_slot *find_slot(const struct oa_dict *d, const char *key, size_t len, uint64_t hash)
+{
+    size_t mask = __atomic_load_n(&d->mask, __ATOMIC_ACQUIRE);
+    struct oa_slot *slots = __atomic_load_n(&d->slots, __ATOMIC_ACQUIRE);
+    size_t i = home(mask, hash);
+    for (size_t dist = 0;; ++dist, i = (i + 1) & mask) {
+        struct oa_slot *slot = &slots[i];
+        struct oa_item *item = __atomic_load_n(&slot->item, __ATOMIC_ACQUIRE);
+        uint64_t slot_hash = __atomic_load_n(&slot->hash, __ATOMIC_RELAXED);
+        /* An empty slot or an item closer to its home: key would be here */
+        if (item == NULL || distance(mask, slot_hash, i) < dist)
+            return NULL;
+        if (slot_hash == hash && item->key_len == len && memcmp(item->key, key, len) == 0)
+            return slot;
+    }
+}
+
+/* place: Robin Hood insert of an item known not to be in the table */
+static void place(struct oa_slot *slots, size_t mask, struct oa_slot in)
+{
+    size_t i = home(mask, in.hash);
+    for (size_t dist = 0;; ++dist, i = (i + 1) & mask) {
+        struct oa_slot *slot = &slots[i];
+        if (slot->item == NULL) {
+            store(slot, in);
+            return;
+        }
+        size_t slot_dist = distance(mask, slot->hash, i);
+        if (slot_dist < dist) {
+            struct oa_slot displaced = *slot;
+            store(slot, in);
+            in = displaced;
+            dist = slot_dist;
+        }
+    }
+}
+
+/* grow: double the slot count and re-place every item, from the cached
+ * hashes. Items themselves don't move. Shared dictionaries keep the old
+ * array, readers may still be probing it. */
+static int grow(struct oa_dict *d)
+{
+    struct oa_slot *old = d->slots;
+    size_t old_size = d->mask + 1;
+    size_t mask = 2 * old_size - 1;
+    struct oa_slot *slots = calloc(mask + 1, sizeof(*slots));
+    struct oa_retired *retired = d->shared ? arena_alloc(d, sizeof(*retired)) : NULL;
+    if (slots == NULL || (d->shared && retired == NULL)) {
+        free(slots);
+        return -1;
+    }
+    for (size_t i = 0; i < old_size; ++i)
+        if (old[i].item != NULL)
+            place(slots, mask, old[i]);
+    __atomic_store_n(&d->slots, slots, __ATOMIC_RELEASE);
+    __atomic_store_n(&d->mask, mask, __ATOMIC_RELEASE);
+    if (retired != NULL) {
+        retired->slots = old;
+        retired->next = d->retired;
+        d->retired = retired;
+    } else {
+        free(old);
+    }
+    return 0;
+}
+
+struct oa_item *oa_lookup(const struct oa_dict *d, const char *s)
+{
+    size_t len = strlen(s);
+    return oa_lookup_hashed(d, s, len, oa_hash(s, len));
+}
+
+struct oa_item *oa_lookup_hashed(const struct oa_dict *d, const char *key, size_t len, uint64_t hash)
+{
+    struct oa_slot *slot = find_slot(d, key, len, hash);
+    return slot == NULL ? NULL : __atomic_load_n(&slot->item, __ATOMIC_ACQUIRE);
+}
+
+/* new_item: item, key and value in one allocation */
+static struct oa_item *new_item(struct oa_dict *d, const char *key, size_t len, const char *value)
+{
+    size_t value_len = strlen(value);
+    struct oa_item *item = arena_alloc(d, sizeof(*item) + len + 1 + value_len + 1);
+    if (item == NULL)
+        return NULL;
+    item->key = (char *) (item + 1);
+    memcpy(item->key, key, len + 1);
+    item->key_len = len;
+    item->value = item->key + len + 1;
+    memcpy(item->value, value, value_len + 1);
+    item->value_cap = value_len;
+    return item;
+}
+
+/* set_value: copy value in place if it fits, else into new arena space */
+static int set_value(struct oa_dict *d, struct oa_item *item, const char *value)
+{
+    size_t len = strlen(value);
+    if (len > item->value_cap) {
+        char *p = arena_alloc(d, len + 1);
+        if (p == NULL)
+            return -1;
+        item->value = p;
+        item->value_cap = len;
+    }
+    memcpy(item->value, value, len + 1);
+    return 0;
+}
+
+struct oa_item *oa_install(struct oa_dict *d, const char *key, const char *value)
+{
+    size_t len = strlen(key);
+    uint64_t hash = oa_hash(key, len);
+    struct oa_slot *slot = find_slot(d, key, len, hash);
+    if (slot != NULL) { /* already there */
+        if (!d->shared)
+            return set_value(d, slot->item, value) == 0 ? slot->item : NULL;
+        /* Readers may be copying the old value, swap in a new item */
+        struct oa_item *item = new_item(d, key, len, value);
+        if (item != NULL)
+            store(slot, (struct oa_slot){hash, item});
+        return item;
+    }
+    if ((d->count + 1) * OA_MAX_LOAD_DEN > (d->mask + 1) * OA_MAX_LOAD_NUM && grow(d) != 0)
+        return NULL;
+    struct oa_item *item = new_item(d, key, len, value);
+    if (item == NULL)
+        return NULL;
+    place(d->slots, d->mask, (struct oa_slot){hash, item});
+    ++d->count;
+    return item;
+}
+
+int oa_remove(struct oa_dict *d, const char *key)
+{
+    size_t len = strlen(key);
+    struct oa_slot *found = find_slot(d, key, len, oa_hash(key, len));
+    if (found == NULL)
+        return 0;
+    /* Shift the following items back until an empty slot or one already at
+     * home, they are all one slot closer to home afterwards */
+    size_t i = (size_t) (found - d->slots);
+    for (;;) {
+        size_t next = (i + 1) & d->mask;
+        struct oa_slot *slot = &d->slots[next];
+        if (slot->item == NULL || distance(d->mask, slot->hash, next) == 0)
+            break;
+        store(&d->slots[i], *slot);
+        i = next;
+    }
+    store(&d->slots[i], (struct oa_slot){0, NULL});
+    --d->count;
+    return 1;
+}
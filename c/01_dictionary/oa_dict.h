@@ -0,0 +1,78 @@
+#ifndef OA_DICT_H
+#define OA_DICT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Open-addressing replacement for dict.c: same lookup/install semantics, but
+ * every dictionary is its own object, the table grows as needed, entries can
+ * be removed and everything is freed by oa_dict_free(). */
+
+struct oa_item {
+    char *key;   /* defined name */
+    char *value; /* replacement text */
+    size_t key_len;
+    size_t value_cap; /* bytes available for value, without the '\0' */
+};
+
+struct oa_slot {
+    uint64_t hash;        /* full hash, so probing and growing never rehash */
+    struct oa_item *item; /* NULL: empty slot */
+};
+
+struct oa_chunk;
+
+struct oa_retired {
+    struct oa_retired *next;
+    struct oa_slot *slots;
+};
+
+struct oa_dict {
+    struct oa_slot *slots;
+    size_t mask;  /* slot count - 1, the slot count is a power of two */
+    size_t count; /* items in the table */
+    struct oa_chunk *chunks; /* arena for items, keys and values */
+    char *arena_next;
+    char *arena_end;
+    /* Set by the caller before the first install: readers may call
+     * oa_lookup_hashed() while a (single) writer changes the table, see
+     * below */
+    int shared;
+    struct oa_retired *retired; /* shared only, slot arrays left by grow */
+};
+
+/* oa_dict_init: an empty dictionary, 0 on success, -1 if out of memory */
+int oa_dict_init(struct oa_dict *d);
+
+/* oa_dict_free: frees the table and every item, key and value */
+void oa_dict_free(struct oa_dict *d);
+
+/* oa_lookup: look for s in d, NULL if not found */
+struct oa_item *oa_lookup(const struct oa_dict *d, const char *s);
+
+/* oa_install: put (key, value) in d, replacing the value if key is already
+ * there. NULL if out of memory. */
+struct oa_item *oa_install(struct oa_dict *d, const char *key, const char *value);
+
+/* oa_remove: remove key from d, 1 if it was there, 0 if not */
+int oa_remove(struct oa_dict *d, const char *key);
+
+/* oa_hash: the hash oa_lookup() uses, for callers that also pick a shard
+ * with it. The slot comes from the upper half, shards should use the low
+ * bits. */
+uint64_t oa_hash(const char *key, size_t len);
+
+/* oa_lookup_hashed: oa_lookup() of a key whose length and hash are known.
+ *
+ * On a shared dictionary it is safe, with no lock, alongside one writer:
+ * items are never modified once in the table (install swaps in a new item),
+ * and slot arrays replaced by growth are kept until oa_dict_free(). The
+ * result may be wrong while the writer moves items around, callers detect
+ * that with a sequence count and retry (see cd_dict.c). */
+struct oa_item *oa_lookup_hashed(const struct oa_dict *d, const char *key, size_t len, uint64_t hash);
+
+/* Items live in an arena, so pointers returned by oa_lookup()/oa_install()
+ * stay valid while the table grows, until the key is removed. Memory of
+ * removed items and replaced values is only reclaimed by oa_dict_free(). */
+
+#endif /* OA_DICT_H */
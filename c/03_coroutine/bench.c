@@ -0,0 +1,141 @@
+// Cost of one switch between two flows of execution:
+// - coro: coro_resume()/coro_yield(), the hand-written context switch on x86-64
+// - ucontext: swapcontext(), which also saves and restores the signal mask, a system call each way
+// - thread: two threads handing a turn to each other through a mutex and condition variables
+// plus the cost of coro_create() + coro_destroy() with a pooled stack.
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "coro.h"
+
+#define SWITCHES 10000000
+#define THREAD_SWITCHES 200000 // each one is a futex wake and wait
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void counter(struct coro *co, void *arg)
+{
+    (void) arg;
+    for (long i = 0;; ++i)
+        coro_yield(co, i);
+}
+
+static double bench_coro(void)
+{
+    struct coro *co = coro_create(counter, NULL);
+    long value = 0, sum = 0;
+    double start = now_ns();
+    for (long i = 0; i < SWITCHES / 2; ++i) {
+        coro_resume(co, &value);
+        sum += value;
+    }
+    double elapsed = now_ns() - start;
+    coro_destroy(co);
+    if (sum != (long) SWITCHES / 2 * (SWITCHES / 2 - 1) / 2) {
+        fprintf(stderr, "coro: wrong values\n");
+        exit(1);
+    }
+    return elapsed / SWITCHES;
+}
+
+static ucontext_t main_context, uc_context;
+
+static void uc_counter(void)
+{
+    for (;;)
+        swapcontext(&uc_context, &main_context);
+}
+
+static double bench_ucontext(void)
+{
+    static char stack[CORO_STACK_SIZE];
+    getcontext(&uc_context);
+    uc_context.uc_stack.ss_sp = stack;
+    uc_context.uc_stack.ss_size = sizeof(stack);
+    uc_context.uc_link = NULL;
+    makecontext(&uc_context, uc_counter, 0);
+    double start = now_ns();
+    for (long i = 0; i < SWITCHES / 2; ++i)
+        swapcontext(&main_context, &uc_context);
+    return (now_ns() - start) / SWITCHES;
+}
+
+struct handoff {
+    pthread_mutex_t lock;
+    pthread_cond_t cond[2];
+    int turn;
+};
+
+static void pass_turn(struct handoff *h, int me)
+{
+    pthread_mutex_lock(&h->lock);
+    h->turn = !me;
+    pthread_cond_signal(&h->cond[!me]);
+    while (h->turn != me)
+        pthread_cond_wait(&h->cond[me], &h->lock);
+    pthread_mutex_unlock(&h->lock);
+}
+
+static void *other_thread(void *arg)
+{
+    struct handoff *h = arg;
+    pthread_mutex_lock(&h->lock);
+    while (h->turn != 1)
+        pthread_cond_wait(&h->cond[1], &h->lock);
+    pthread_mutex_unlock(&h->lock);
+    for (long i = 0; i < THREAD_SWITCHES / 2 - 1; ++i)
+        pass_turn(h, 1);
+    // Last one, without waiting for a turn that never comes
+    pthread_mutex_lock(&h->lock);
+    h->turn = 0;
+    pthread_cond_signal(&h->cond[0]);
+    pthread_mutex_unlock(&h->lock);
+    return NULL;
+}
+
+static double bench_thread(void)
+{
+    struct handoff h = {PTHREAD_MUTEX_INITIALIZER, {PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER}, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, other_thread, &h);
+    double start = now_ns();
+    for (long i = 0; i < THREAD_SWITCHES / 2; ++i)
+        pass_turn(&h, 0);
+    double elapsed = now_ns() - start;
+    pthread_join(thread, NULL);
+    return elapsed / THREAD_SWITCHES;
+}
+
+static void noop(struct coro *co, void *arg)
+{
+    (void) co;
+    (void) arg;
+}
+
+static double bench_create(void)
+{
+    const long n = 1000000;
+    double start = now_ns();
+    for (long i = 0; i < n; ++i) {
+        struct coro *co = coro_create(noop, NULL);
+        coro_resume(co, NULL);
+        coro_destroy(co);
+    }
+    return (now_ns() - start) / n;
+}
+
+int main() {
+    printf("%-30s %8.1f ns/switch\n", "coro_resume/coro_yield", bench_coro());
+    printf("%-30s %8.1f ns/switch\n", "swapcontext", bench_ucontext());
+    printf("%-30s %8.1f ns/switch\n", "thread, condition variable", bench_thread());
+    printf("%-30s %8.1f ns\n", "coro_create/resume/destroy", bench_create());
+    return 0;
+}
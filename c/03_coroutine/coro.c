@@ -0,0 +1,234 @@
+#include "coro.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if !defined(__x86_64__)
+#include <ucontext.h>
+#endif
+
+/* The coroutine itself lives at the top of its stack mapping, so one mmap() holds both. */
+struct coro {
+    coro_fn fn;
+    void *arg;
+    long value;
+    int done;
+#if defined(__x86_64__)
+    void *sp;        /* coroutine's stack pointer while suspended */
+    void *caller_sp; /* resumer's stack pointer while the coroutine runs */
+#else
+    ucontext_t context;
+    ucontext_t caller;
+#endif
+    struct coro *next_free; /* pool list */
+    size_t map_size;
+};
+
+/* Stack pool */
+
+#define CORO_POOL_MAX 64 /* free stacks kept per thread, the rest are unmapped */
+
+static _Thread_local struct coro *pool;
+static _Thread_local size_t pool_size;
+
+static struct coro *stack_alloc(void)
+{
+    if (pool != NULL) {
+        struct coro *co = pool;
+        pool = co->next_free;
+        --pool_size;
+        return co;
+    }
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t usable = (CORO_STACK_SIZE + sizeof(struct coro) + page - 1) / page * page;
+    size_t map_size = page + usable;
+    char *base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+    // The stack grows down, the guard page is the lowest one
+    if (mprotect(base, page, PROT_NONE) != 0) {
+        munmap(base, map_size);
+        return NULL;
+    }
+    struct coro *co = (struct coro *) (base + map_size) - 1;
+    co->map_size = map_size;
+    return co;
+}
+
+static void stack_free(struct coro *co)
+{
+    if (pool_size < CORO_POOL_MAX) {
+        co->next_free = pool;
+        pool = co;
+        ++pool_size;
+        return;
+    }
+    munmap((char *) (co + 1) - co->map_size, co->map_size);
+}
+
+/* Highest usable stack address, below the struct coro, 16-byte aligned */
+static char *stack_top(struct coro *co)
+{
+    return (char *) ((uintptr_t) co & ~(uintptr_t) 15);
+}
+
+static void coro_main(struct coro *co);
+
+#if defined(__x86_64__)
+
+/**
+ * coro_switch(&from->sp, to_sp): push the callee-saved registers (the System V ABI lets a call clobber all the
+ * others) on the current stack, save the stack pointer, then load to_sp and pop the other side's registers. The ret
+ * returns into whatever called coro_switch() on the other side, or into coro_trampoline for a new coroutine.
+ *
+ * The control bits of MXCSR and of the x87 control word (rounding mode, exception masks) are callee-saved too, so
+ * each side keeps its own: both are stored in one 8-byte slot below the registers.
+ */
+void coro_switch(void **from_sp, void *to_sp);
+__asm__(".text\n"
+        ".p2align 4\n"
+        ".type coro_switch, @function\n"
+        "coro_switch:\n"
+        "    pushq %rbp\n"
+        "    pushq %rbx\n"
+        "    pushq %r12\n"
+        "    pushq %r13\n"
+        "    pushq %r14\n"
+        "    pushq %r15\n"
+        "    subq $8, %rsp\n"
+        "    stmxcsr (%rsp)\n"
+        "    fnstcw 4(%rsp)\n"
+        "    movq %rsp, (%rdi)\n"
+        "    movq %rsi, %rsp\n"
+        "    ldmxcsr (%rsp)\n"
+        "    fldcw 4(%rsp)\n"
+        "    addq $8, %rsp\n"
+        "    popq %r15\n"
+        "    popq %r14\n"
+        "    popq %r13\n"
+        "    popq %r12\n"
+        "    popq %rbx\n"
+        "    popq %rbp\n"
+        "    ret\n"
+        ".size coro_switch, .-coro_switch\n"
+        /* First switch into a coroutine: rbx = co, r12 = coro_main. A jmp, not a call, so that coro_main starts with
+         * the stack alignment of a called function, with a zero return address. */
+        ".p2align 4\n"
+        "coro_trampoline:\n"
+        "    movq %rbx, %rdi\n"
+        "    jmpq *%r12\n");
+void coro_trampoline(void);
+
+static void context_init(struct coro *co)
+{
+    /* What coro_switch() pops: MXCSR and the x87 control word, r15, r14, r13, r12, rbx, rbp, then the return
+     * address. After the ret the stack pointer must be 8 mod 16, as right after a call. The coroutine starts with
+     * the floating point modes of its creator, as getcontext() would give it. */
+    uint32_t fp_modes[2];
+    __asm__ volatile("stmxcsr %0\n\tfnstcw %1" : "=m"(fp_modes[0]), "=m"(fp_modes[1]));
+    fp_modes[1] &= 0xffff; /* fnstcw stores 16 bits */
+    void **sp = (void **) stack_top(co) - 1;
+    *sp = NULL; /* coro_main's return address, it never returns */
+    *--sp = (void *) coro_trampoline;
+    *--sp = NULL;              /* rbp */
+    *--sp = co;                /* rbx */
+    *--sp = (void *) coro_main; /* r12 */
+    *--sp = NULL;              /* r13 */
+    *--sp = NULL;              /* r14 */
+    *--sp = NULL;              /* r15 */
+    sp -= 1;
+    memcpy(sp, fp_modes, sizeof(fp_modes));
+    co->sp = sp;
+}
+
+static inline void switch_in(struct coro *co)
+{
+    coro_switch(&co->caller_sp, co->sp);
+}
+
+static inline void switch_out(struct coro *co)
+{
+    coro_switch(&co->sp, co->caller_sp);
+}
+
+#else
+
+static void ucontext_entry(unsigned hi, unsigned lo)
+{
+    // makecontext() only passes ints. Split through uint64_t, the shifts are then defined whatever the pointer size.
+    coro_main((struct coro *) (uintptr_t) (((uint64_t) hi << 32) | lo));
+}
+
+static void context_init(struct coro *co)
+{
+    getcontext(&co->context);
+    co->context.uc_stack.ss_sp = (char *) (co + 1) - co->map_size + sysconf(_SC_PAGESIZE);
+    co->context.uc_stack.ss_size = (size_t) (stack_top(co) - (char *) co->context.uc_stack.ss_sp);
+    co->context.uc_link = NULL;
+    uint64_t p = (uintptr_t) co;
+    makecontext(&co->context, (void (*)(void)) ucontext_entry, 2, (unsigned) (p >> 32), (unsigned) (p & 0xffffffff));
+}
+
+static inline void switch_in(struct coro *co)
+{
+    swapcontext(&co->caller, &co->context);
+}
+
+static inline void switch_out(struct coro *co)
+{
+    swapcontext(&co->context, &co->caller);
+}
+
+#endif
+
+static void coro_main(struct coro *co)
+{
+    co->fn(co, co->arg);
+    co->done = 1;
+    switch_out(co);
+    abort(); // a finished coroutine is never switched back in
+}
+
+struct coro *coro_create(coro_fn fn, void *arg)
+{
+    struct coro *co = stack_alloc();
+    if (co == NULL)
+        return NULL;
+    co->fn = fn;
+    co->arg = arg;
+    co->value = 0;
+    co->done = 0;
+    context_init(co);
+    return co;
+}
+
+int coro_resume(struct coro *co, long *value)
+{
+    if (co->done)
+        return 0;
+    switch_in(co);
+    if (co->done)
+        return 0;
+    if (value != NULL)
+        *value = co->value;
+    return 1;
+}
+
+void coro_yield(struct coro *co, long value)
+{
+    co->value = value;
+    switch_out(co);
+}
+
+int coro_done(const struct coro *co)
+{
+    return co->done;
+}
+
+void coro_destroy(struct coro *co)
+{
+    stack_free(co);
+}
@@ -0,0 +1,52 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <stddef.h>
+
+/**
+ * Stackful coroutines: every coroutine runs on its own stack, so it can yield from anywhere, including from functions
+ * it calls, and any number of them can be suspended at once. Switching is a hand-written context switch on x86-64
+ * (only the callee-saved registers and the stack pointer, a few ns) and ucontext elsewhere.
+ *
+ * Stacks are mmap()ed with a PROT_NONE guard page below them, so an overflow segfaults instead of corrupting memory,
+ * and are pooled per thread: creating a coroutine after one was destroyed costs no system call.
+ *
+ * A coroutine belongs to the thread that created it and must be resumed from that thread only.
+ */
+
+#define CORO_STACK_SIZE (64 * 1024) /* usable bytes, plus one guard page */
+
+struct coro;
+
+/* The body of a coroutine, it finishes when fn returns */
+typedef void (*coro_fn)(struct coro *co, void *arg);
+
+/**
+ * @brief a suspended coroutine that will run fn(co, arg) when first resumed
+ * @return NULL if out of memory
+ */
+struct coro *coro_create(coro_fn fn, void *arg);
+
+/**
+ * @brief run co until its next coro_yield() or until it finishes
+ *
+ * @param value where the yielded value is stored, can be NULL
+ * @return 1 if co yielded, 0 if it has finished (now or before), *value is then unchanged
+ */
+int coro_resume(struct coro *co, long *value);
+
+/**
+ * @brief suspend co, called from inside it, and make its coro_resume() return 1 with value
+ */
+void coro_yield(struct coro *co, long value);
+
+/* coro_done: 1 once fn has returned */
+int coro_done(const struct coro *co);
+
+/**
+ * @brief return co's stack to the pool. A suspended coroutine can be destroyed, it's simply never resumed, but
+ * nothing on its stack is cleaned up.
+ */
+void coro_destroy(struct coro *co);
+
+#endif /* CORO_H */
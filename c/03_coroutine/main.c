@@ -1,46 +1,57 @@
 // C program to demonstrate how coroutines
 // can be implemented in C.
-#include<stdio.h>
- 
+#include <stdio.h>
+
+#include "coro.h"
+
+struct range_args {
+    long a;
+    long b;
+};
+
 /**
- * @brief emulate a range() iterator in C, making it behave like a coroutine
- * 
- * @param a inclusive lower bound
- * @param b exclusive upper bound
- * @return number to be "yield"ed
+ * @brief emulate a range() iterator in C: a real coroutine this time, see coro.h
+ *
+ * Every call to coro_create(range, ...) is an independent generator with its own i on its own stack, so several can
+ * be iterated at once, and the bounds can be anything: the end of the range is coro_resume() returning 0, not a
+ * special value.
+ *
+ * @param arg a struct range_args, a is the inclusive lower bound, b the exclusive upper bound
  */
-int range(int a, int b)
+static void range(struct coro *co, void *arg)
 {
-    if (a <= 0) {
-        fprintf(stderr, "This implementation doesn't support any non-positive lower bound...\n");
-        return 0;
+    const struct range_args *r = arg;
+    for (long i = r->a; i < r->b; ++i) {
+        coro_yield(co, i);
+        printf("\"resumes\" execution@range(%ld, %ld)\n", r->a, r->b);
     }
-    static long long int i;
-    // the static keyword is the key: it extends the lifetime of the variable.
-    // WithOUT static, the lifetime is from the entry into range() to the return from range()
-    // With static, the variable's lifetime is the same as the lifetime of the programm.
-    // That is, if range() is called again, i's value will be the same as previous call.
-    static int state = 0;
-    if (state == 0) {
-        state = 1;
-        i = a;
-    }
-    while (i < b) {
-        printf("\"resumes\" execution@range()\n");
-        ++i;
-        return (i-1);
-    }
-    
-    state = 0;
-    return 0;
 }
- 
+
 int main() {
-    int i;
- 
-    while (i=range(1, 50)) {
-        printf("i is: %d@main()\n", i);
+    long i, j;
+
+    struct range_args args = {1, 5};
+    struct coro *gen = coro_create(range, &args);
+    while (coro_resume(gen, &i)) {
+        printf("i is: %ld@main()\n", i);
+    }
+    // Finished generators stay finished
+    printf("resumed again: %d\n", coro_resume(gen, &i));
+    coro_destroy(gen);
+
+    // Two at once, including non-positive bounds
+    struct range_args args_i = {-3, 1}, args_j = {10, 13};
+    struct coro *gen_i = coro_create(range, &args_i);
+    struct coro *gen_j = coro_create(range, &args_j);
+    int more_i = 1, more_j = 1;
+    while ((more_i = more_i && coro_resume(gen_i, &i)) | (more_j = more_j && coro_resume(gen_j, &j))) {
+        if (more_i)
+            printf("i is: %ld@main()\n", i);
+        if (more_j)
+            printf("j is: %ld@main()\n", j);
     }
- 
+    coro_destroy(gen_i);
+    coro_destroy(gen_j);
+
     return 0;
 }
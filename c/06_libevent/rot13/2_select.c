@@ -1,3 +1,5 @@
+/* For memrchr */
+#define _GNU_SOURCE
 /* For sockaddr_in */
 #include <netinet/in.h>
 /* For socket functions */
@@ -14,18 +16,9 @@
 #include <string.h>
 #include <unistd.h>
 
-#define MAX_LINE 16384
+#include "rot13.h"
 
-char rot13_char(char c) {
-  /* We don't want to use isalpha here; setting the locale would change
-   * which characters are considered alphabetical. */
-  if ((c >= 'a' && c <= 'm') || (c >= 'A' && c <= 'M'))
-    return c + 13;
-  else if ((c >= 'n' && c <= 'z') || (c >= 'N' && c <= 'Z'))
-    return c - 13;
-  else
-    return c;
-}
+#define MAX_LINE 16384
 
 struct fd_state {
   char buffer[MAX_LINE];
@@ -50,21 +43,33 @@ void free_fd_state(struct fd_state *state) { free(state); }
 void make_nonblocking(int fd) { fcntl(fd, F_SETFL, O_NONBLOCK); }
 
 int do_read(int fd, struct fd_state *state) {
-  char buf[1024];
-  int i;
+  char discard[1024];
+  char *p, *nl;
   ssize_t result;
   while (1) {
-    result = recv(fd, buf, sizeof(buf), 0);
-    if (result <= 0)
-      break;
-
-    for (i = 0; i < result; ++i) {
-      if (state->buffer_used < sizeof(state->buffer))
-        state->buffer[state->buffer_used++] = rot13_char(buf[i]);
-      if (buf[i] == '\n') {
-        state->writing = 1;
-        state->write_upto = state->buffer_used;
-      }
+    /* Straight into the buffer and rot13ed there, a whole recv() at a time.
+     * Once it's full, the rest of the line is read and dropped, only its
+     * newline counts. */
+    if (state->buffer_used < sizeof(state->buffer)) {
+      p = state->buffer + state->buffer_used;
+      result = recv(fd, p, sizeof(state->buffer) - state->buffer_used, 0);
+      if (result <= 0)
+        break;
+      rot13_buffer(p, (size_t)result);
+      state->buffer_used += result;
+    } else {
+      p = discard;
+      result = recv(fd, p, sizeof(discard), 0);
+      if (result <= 0)
+        break;
+    }
+
+    /* Up to the last newline, rot13 leaves '\n' alone */
+    nl = (char *)memrchr(p, '\n', (size_t)result);
+    if (nl != NULL) {
+      state->writing = 1;
+      state->write_upto =
+          p == discard ? state->buffer_used : (size_t)(nl + 1 - state->buffer);
     }
   }
 
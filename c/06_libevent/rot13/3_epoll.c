@@ -0,0 +1,297 @@
+/* For accept4, memrchr and pthread_setaffinity_np */
+#define _GNU_SOURCE
+/* For sockaddr_in */
+#include <netinet/in.h>
+/* For socket functions */
+#include <sys/socket.h>
+/* for epoll */
+#include <sys/epoll.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ringbuf.h"
+#include "rot13.h"
+
+/* Compared to 2_select.c: no FD_SETSIZE limit, epoll_wait() returns only the
+ * ready connections instead of every fd being scanned on each loop, and each
+ * connection has a ring buffer that grows with what it has pending instead
+ * of a fixed 16 KB that drops the rest of a long line. */
+
+#define MAX_EVENTS 1024
+#define READ_CHUNK 4096
+/* More than this buffered for one connection: if it's all one unfinished
+ * line the client is closed, otherwise reading pauses until the client has
+ * read some of the replies (backpressure). */
+#define MAX_BUFFERED (1024 * 1024)
+
+struct conn {
+  int fd;
+  /* rot13ed bytes, [head, write_upto) are complete lines to send */
+  struct ringbuf buf;
+  uint64_t write_upto;
+  int read_paused;
+  int eof;
+  int hup; /* EPOLLRDHUP or EPOLLHUP seen: the FIN is queued behind the data */
+  int want_out; /* EPOLLOUT registered, only while a write is blocked */
+};
+
+/* The bytes just read, in place: rot13 them and move write_upto past the
+ * last newline among them */
+void rot13_new_bytes(struct conn *c, size_t n) {
+  struct iovec iov[2];
+  int count = ringbuf_segments(&c->buf, c->buf.tail, n, iov);
+  uint64_t pos = c->buf.tail;
+  int i;
+  for (i = 0; i < count; ++i) {
+    char *p = (char *)iov[i].iov_base;
+    char *nl = (char *)memrchr(p, '\n', iov[i].iov_len);
+    rot13_buffer(p, iov[i].iov_len);
+    if (nl != NULL)
+      c->write_upto = pos + (uint64_t)(nl - p) + 1;
+    pos += iov[i].iov_len;
+  }
+  c->buf.tail += n;
+}
+
+/* Edge-triggered: read until the socket is drained, or until the buffer is
+ * full. 0 on success, -1 on error or a line longer than MAX_BUFFERED. */
+int do_read(struct conn *c) {
+  struct iovec iov[2];
+  ssize_t result;
+  size_t space;
+  while (!c->eof && !c->read_paused) {
+    if (ringbuf_used(&c->buf) >= MAX_BUFFERED) {
+      if (c->write_upto == c->buf.head)
+        return -1;
+      c->read_paused = 1;
+      return 0;
+    }
+    if (ringbuf_reserve(&c->buf, READ_CHUNK) != 0)
+      return -1;
+    space = c->buf.size - ringbuf_used(&c->buf);
+    result = readv(c->fd, iov, ringbuf_free_space(&c->buf, iov));
+    if (result > 0) {
+      rot13_new_bytes(c, (size_t)result);
+      /* A short read emptied the socket, whatever arrives later is a new
+       * edge: no need for the extra read that returns EAGAIN. Unless the
+       * peer has hung up: its FIN came with the same edge as the data, and
+       * only the read that returns 0 will see it. */
+      if ((size_t)result < space && !c->hup)
+        return 0;
+    } else if (result == 0) {
+      c->eof = 1;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
+    } else if (errno != EINTR) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* EPOLLOUT only while a write is blocked: registered for good, the edge
+ * would also be reported every time an ACK frees send buffer space, twice
+ * the wakeups for a request/response protocol */
+int want_out(int epfd, struct conn *c, int on) {
+  struct epoll_event ev;
+  if (c->want_out == on)
+    return 0;
+  c->want_out = on;
+  ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (on ? EPOLLOUT : 0);
+  ev.data.ptr = c;
+  return epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+/* Send complete lines until EAGAIN. 0 on success, -1 on error. */
+int do_write(int epfd, struct conn *c) {
+  struct iovec iov[2];
+  ssize_t result;
+  while (c->buf.head < c->write_upto) {
+    result = writev(c->fd, iov,
+                    ringbuf_segments(&c->buf, c->buf.head,
+                                     (size_t)(c->write_upto - c->buf.head),
+                                     iov));
+    if (result < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return want_out(epfd, c, 1);
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    c->buf.head += result;
+  }
+  if (want_out(epfd, c, 0) < 0)
+    return -1;
+  /* Idle connections give their memory back, 10K of them add up */
+  if (ringbuf_used(&c->buf) == 0 && c->buf.size > RINGBUF_INITIAL_SIZE) {
+    ringbuf_free(&c->buf);
+    c->write_upto = 0;
+  }
+  return 0;
+}
+
+/* 1: the connection is done, close it. -1: error, close it too. */
+int handle(int epfd, struct conn *c) {
+  while (1) {
+    if (do_read(c) < 0 || do_write(epfd, c) < 0)
+      return -1;
+    /* A final line without a newline is dropped, like 2_select.c does */
+    if (c->eof && c->buf.head == c->write_upto)
+      return 1;
+    if (!c->read_paused || ringbuf_used(&c->buf) >= MAX_BUFFERED)
+      return 0;
+    /* Drained enough to read again. Edge-triggered epoll won't report data
+     * that was already there, so read it now. */
+    c->read_paused = 0;
+  }
+}
+
+void close_conn(struct conn *c) {
+  close(c->fd); /* also removes it from the epoll set */
+  ringbuf_free(&c->buf);
+  free(c);
+}
+
+void accept_all(int epfd, int listener) {
+  while (1) {
+    struct epoll_event ev;
+    struct conn *c;
+    int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK);
+    if (fd < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        perror("accept");
+      /* EMFILE and the like: the rest stay in the backlog, edge-triggered
+       * epoll reports them again with the next new connection */
+      return;
+    }
+    c = (struct conn *)calloc(1, sizeof(*c));
+    if (c == NULL) {
+      close(fd);
+      continue;
+    }
+    c->fd = fd;
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = c;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      perror("epoll_ctl");
+      close_conn(c);
+    }
+  }
+}
+
+/* One event loop. With several, each has its own listener on the same port
+ * (SO_REUSEPORT: the kernel spreads new connections across the listeners by
+ * hash) and is pinned to its own core, so a connection is accepted, read and
+ * written on one core and the loops share nothing. */
+struct loop {
+  pthread_t thread;
+  int cpu; /* -1: not pinned, the single-loop mode */
+};
+
+void *run(void *arg) {
+  struct loop *loop = (struct loop *)arg;
+  int listener, epfd, i, n;
+  struct sockaddr_in sin;
+  struct epoll_event ev, events[MAX_EVENTS];
+
+  if (loop->cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(loop->cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  }
+
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = 0;
+  sin.sin_port = htons(40713);
+
+  listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+
+  {
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    /* Only with several loops: otherwise a second copy of the server
+     * started by mistake would silently take half the connections */
+    if (loop->cpu >= 0)
+      setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  }
+
+  if (bind(listener, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+    perror("bind");
+    return NULL;
+  }
+
+  if (listen(listener, SOMAXCONN) < 0) {
+    perror("listen");
+    return NULL;
+  }
+
+  epfd = epoll_create1(0);
+  if (epfd < 0) {
+    perror("epoll_create1");
+    return NULL;
+  }
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.ptr = NULL; /* the listener */
+  if (epoll_ctl(epfd, EPOLL_CTL_ADD, listener, &ev) < 0) {
+    perror("epoll_ctl");
+    return NULL;
+  }
+
+  while (1) {
+    n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("epoll_wait");
+      return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+      struct conn *c = (struct conn *)events[i].data.ptr;
+      if (c == NULL) {
+        accept_all(epfd, listener);
+        continue;
+      }
+      if (events[i].events & (EPOLLRDHUP | EPOLLHUP))
+        c->hup = 1;
+      if (handle(epfd, c) != 0)
+        close_conn(c);
+    }
+  }
+}
+
+/* Usage: 3_epoll.out [loops]. 1 by default, 0 for one per core. */
+int main(int argc, char *argv[]) {
+  long n_loops = argc > 1 ? strtol(argv[1], NULL, 10) : 1;
+  long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  struct loop *loops;
+  long i;
+
+  setvbuf(stdout, NULL, _IONBF, 0);
+
+  if (n_loops <= 0)
+    n_loops = n_cpus;
+  if (n_loops == 1) {
+    struct loop loop = {0, -1};
+    run(&loop);
+    return 1;
+  }
+  loops = (struct loop *)calloc((size_t)n_loops, sizeof(*loops));
+  if (loops == NULL)
+    return 1;
+  for (i = 0; i < n_loops; ++i) {
+    loops[i].cpu = (int)(i % n_cpus);
+    pthread_create(&loops[i].thread, NULL, run, &loops[i]);
+  }
+  /* The loops only return on errors */
+  for (i = 0; i < n_loops; ++i)
+    pthread_join(loops[i].thread, NULL);
+  free(loops);
+  return 1;
+}
@@ -0,0 +1,218 @@
+/* For pthread_setaffinity_np */
+#define _GNU_SOURCE
+/* For sockaddr_in */
+#include <netinet/in.h>
+/* For socket functions */
+#include <sys/socket.h>
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rot13.h"
+
+/* The same server on libevent: an evconnlistener accepts and each connection
+ * is a bufferevent, whose input and output evbuffers grow as needed (chains
+ * of chunks rather than one ring, libevent's own growable buffer). Complete
+ * lines are moved from input to output with one copy and rot13ed in place,
+ * no per-line allocation like evbuffer_readln() would do. */
+
+/* Longest line accepted, and the most output queued for one client before
+ * reading from it pauses, the same limit as 3_epoll.c */
+#define MAX_BUFFERED (1024 * 1024)
+
+void read_cb(struct bufferevent *bev, void *ctx) {
+  struct evbuffer *input = bufferevent_get_input(bev);
+  struct evbuffer *output = bufferevent_get_output(bev);
+  struct evbuffer_ptr eol;
+  struct evbuffer_iovec vec;
+  size_t lines_len = 0, eol_len;
+  (void)ctx;
+
+  /* Up to the end of the last complete line */
+  evbuffer_ptr_set(input, &eol, 0, EVBUFFER_PTR_SET);
+  while (1) {
+    eol = evbuffer_search_eol(input, &eol, &eol_len, EVBUFFER_EOL_LF);
+    if (eol.pos < 0)
+      break;
+    lines_len = (size_t)eol.pos + eol_len;
+    evbuffer_ptr_set(input, &eol, lines_len, EVBUFFER_PTR_SET);
+  }
+  if (lines_len == 0) {
+    if (evbuffer_get_length(input) > MAX_BUFFERED)
+      bufferevent_free(bev); /* a line that never ends */
+    return;
+  }
+
+  if (evbuffer_reserve_space(output, (ev_ssize_t)lines_len, &vec, 1) != 1) {
+    bufferevent_free(bev);
+    return;
+  }
+  evbuffer_remove(input, vec.iov_base, lines_len);
+  rot13_buffer((char *)vec.iov_base, lines_len);
+  vec.iov_len = lines_len;
+  evbuffer_commit_space(output, &vec, 1);
+
+  /* Backpressure: the client isn't reading its replies, stop reading its
+   * requests until write_cb sees the output drained */
+  if (evbuffer_get_length(output) > MAX_BUFFERED)
+    bufferevent_disable(bev, EV_READ);
+}
+
+void write_cb(struct bufferevent *bev, void *ctx) {
+  (void)ctx;
+  /* Called when the output drops to the low watermark, 0: all sent */
+  if (!(bufferevent_get_enabled(bev) & EV_READ)) {
+    bufferevent_enable(bev, EV_READ);
+    /* What arrived meanwhile is already in the input buffer */
+    read_cb(bev, ctx);
+  }
+}
+
+/* After EOF: the last replies have been sent */
+void drained_cb(struct bufferevent *bev, void *ctx) {
+  (void)ctx;
+  bufferevent_free(bev);
+}
+
+void event_cb(struct bufferevent *bev, short events, void *ctx) {
+  (void)ctx;
+  /* A reset is how most clients hang up, nothing to report */
+  if ((events & BEV_EVENT_ERROR) && EVUTIL_SOCKET_ERROR() != ECONNRESET)
+    perror("bufferevent");
+  if (events & BEV_EVENT_ERROR) {
+    bufferevent_free(bev);
+  } else if (events & BEV_EVENT_EOF) {
+    /* A half-close: the client may still be reading the replies to its last
+     * lines, free only once they are out (a final line without a newline is
+     * dropped, like the other servers do) */
+    if (evbuffer_get_length(bufferevent_get_output(bev)) == 0) {
+      bufferevent_free(bev);
+      return;
+    }
+    bufferevent_disable(bev, EV_READ);
+    bufferevent_setcb(bev, NULL, drained_cb, event_cb, NULL);
+  }
+}
+
+void accept_cb(struct evconnlistener *listener, evutil_socket_t fd,
+               struct sockaddr *sa, int socklen, void *ctx) {
+  struct event_base *base = evconnlistener_get_base(listener);
+  struct bufferevent *bev =
+      bufferevent_socket_new(base, fd, BEV_OPT_CLOSE_ON_FREE);
+  (void)sa;
+  (void)socklen;
+  (void)ctx;
+  if (bev == NULL) {
+    evutil_closesocket(fd);
+    return;
+  }
+  bufferevent_setcb(bev, read_cb, write_cb, event_cb, NULL);
+  bufferevent_enable(bev, EV_READ | EV_WRITE);
+}
+
+void accept_error_cb(struct evconnlistener *listener, void *ctx) {
+  (void)listener;
+  (void)ctx;
+  /* EMFILE and the like, keep serving the connections we have */
+  perror("accept");
+}
+
+/* One event_base per loop, as in 3_epoll.c: each has its own SO_REUSEPORT
+ * listener and is pinned to its own core. libevent isn't used across
+ * threads here, so it needs no locking setup. */
+struct loop {
+  pthread_t thread;
+  int cpu; /* -1: not pinned, the single-loop mode */
+  int retval;
+};
+
+void *run(void *arg) {
+  struct loop *loop = (struct loop *)arg;
+  struct sockaddr_in sin;
+  struct event_base *base;
+  struct evconnlistener *listener;
+  unsigned flags = LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE;
+
+  loop->retval = 0;
+  if (loop->cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(loop->cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    /* Only with several loops, see 3_epoll.c */
+    flags |= LEV_OPT_REUSEABLE_PORT;
+  }
+
+  base = event_base_new();
+  if (base == NULL) {
+    fprintf(stderr, "Failed to create event base\n");
+    loop->retval = 1;
+    return NULL;
+  }
+
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = 0;
+  sin.sin_port = htons(40713);
+
+  listener = evconnlistener_new_bind(base, accept_cb, NULL, flags, SOMAXCONN,
+                                     (struct sockaddr *)&sin, sizeof(sin));
+  if (listener == NULL) {
+    perror("bind");
+    loop->retval = 1;
+    goto err_listener;
+  }
+  evconnlistener_set_error_cb(listener, accept_error_cb);
+
+  if (event_base_dispatch(base) == -1) {
+    fprintf(stderr, "Failed to event_base_dispatch()\n");
+    loop->retval = 1;
+  }
+
+  evconnlistener_free(listener);
+err_listener:
+  event_base_free(base);
+  return NULL;
+}
+
+/* Usage: 4_libevent.out [loops]. 1 by default, 0 for one per core. */
+int main(int argc, char *argv[]) {
+  long n_loops = argc > 1 ? strtol(argv[1], NULL, 10) : 1;
+  long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  struct loop *loops;
+  int retval = 0;
+  long i;
+
+  setvbuf(stdout, NULL, _IONBF, 0);
+
+  if (n_loops <= 0)
+    n_loops = n_cpus;
+  if (n_loops == 1) {
+    struct loop loop = {0, -1, 0};
+    run(&loop);
+    return loop.retval;
+  }
+  loops = (struct loop *)calloc((size_t)n_loops, sizeof(*loops));
+  if (loops == NULL)
+    return 1;
+  for (i = 0; i < n_loops; ++i) {
+    loops[i].cpu = (int)(i % n_cpus);
+    pthread_create(&loops[i].thread, NULL, run, &loops[i]);
+  }
+  for (i = 0; i < n_loops; ++i) {
+    pthread_join(loops[i].thread, NULL);
+    retval |= loops[i].retval;
+  }
+  free(loops);
+  return retval;
+}
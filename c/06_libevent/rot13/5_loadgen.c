@@ -0,0 +1,372 @@
+/* For sockaddr_in */
+#include <netinet/in.h>
+/* For inet_pton */
+#include <arpa/inet.h>
+/* For socket functions */
+#include <sys/socket.h>
+/* for epoll */
+#include <sys/epoll.h>
+/* For setrlimit */
+#include <sys/resource.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rot13.h"
+
+/* Load generator for the rot13 servers: opens N concurrent connections to
+ * port 40713, then every connection sends one line, waits for its rot13 and
+ * sends the next (closed loop) for D seconds. Reports connections/s,
+ * requests/s, bytes/s and the latency distribution, one line per run so that
+ * runs against 1_fork, 2_select, 3_epoll and 4_libevent line up, see
+ * bench.sh and scale.sh.
+ *
+ * The connections are split over T threads, each with its own epoll loop,
+ * so that the generator isn't the bottleneck when the server uses several
+ * cores. With R requests per connection, a connection is closed after R
+ * replies and a new one opened (connection churn), which measures accept
+ * throughput; with 0, connections stay open and conn/s is the rate of the
+ * initial connects.
+ *
+ * Usage: 5_loadgen.out [label] [connections, 10000] [seconds, 10]
+ *                      [threads, 1] [requests per connection, 0]
+ *                      [host, 127.0.0.1] */
+
+#define PORT 40713
+#define MAX_EVENTS 1024
+#define MAX_CONNECTING 256 /* connects in flight, old servers listen(16) */
+#define CONNECT_TIMEOUT_NS (10 * 1000000000LL)
+
+#define REQUEST_FORMAT "Hello, rot13 server! %010u\n"
+#define REQUEST_LEN 32
+
+enum conn_state { IDLE, CONNECTING, WAITING, DEAD };
+
+struct conn {
+  int fd;
+  enum conn_state state;
+  unsigned seq;
+  int64_t sent_ns;
+  char expected[REQUEST_LEN];
+  size_t received;
+  int reconnecting; /* churn: connects after the first one */
+};
+
+/* Latency histogram in microseconds: exact below 1024, then 64 buckets per
+ * power of two (under 2% error) */
+#define SUB_BUCKETS 64
+#define N_BUCKETS (1024 + 54 * SUB_BUCKETS)
+
+size_t bucket_of(uint64_t us) {
+  int e;
+  if (us < 1024)
+    return (size_t)us;
+  e = 63 - __builtin_clzll(us);
+  return 1024 + (size_t)(e - 10) * SUB_BUCKETS +
+         (size_t)((us >> (e - 6)) & (SUB_BUCKETS - 1));
+}
+
+uint64_t value_of(size_t bucket) {
+  size_t e;
+  if (bucket < 1024)
+    return bucket;
+  e = (bucket - 1024) / SUB_BUCKETS + 10;
+  return ((uint64_t)(SUB_BUCKETS + (bucket - 1024) % SUB_BUCKETS))
+         << (e - 6);
+}
+
+uint64_t percentile(const uint64_t *histogram, uint64_t total, double p) {
+  uint64_t rank = (uint64_t)(total * p / 100.0), seen = 0;
+  size_t i;
+  for (i = 0; i < N_BUCKETS; ++i) {
+    seen += histogram[i];
+    if (seen > rank)
+      return value_of(i);
+  }
+  return value_of(N_BUCKETS - 1);
+}
+
+int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* 0 on success, -1: the connection is dead */
+int send_request(struct conn *c) {
+  char request[REQUEST_LEN + 1];
+  int i;
+  snprintf(request, sizeof(request), REQUEST_FORMAT, ++c->seq);
+  for (i = 0; i < REQUEST_LEN; ++i)
+    c->expected[i] = rot13_char(request[i]);
+  c->received = 0;
+  c->sent_ns = now_ns();
+  c->state = WAITING;
+  /* 32 bytes into an empty socket buffer, short writes don't happen */
+  return send(c->fd, request, REQUEST_LEN, MSG_NOSIGNAL) == REQUEST_LEN ? 0
+                                                                       : -1;
+}
+
+/* 1: a whole, correct response, 0: not complete yet, -1: error */
+int read_response(struct conn *c) {
+  char buf[REQUEST_LEN];
+  ssize_t result;
+  while (c->received < REQUEST_LEN) {
+    result = recv(c->fd, buf, REQUEST_LEN - c->received, 0);
+    if (result == 0)
+      return -1;
+    if (result < 0)
+      return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    if (memcmp(buf, c->expected + c->received, (size_t)result) != 0)
+      return -1;
+    c->received += (size_t)result;
+  }
+  return 1;
+}
+
+struct worker {
+  pthread_t thread;
+  struct sockaddr_in sin;
+  size_t n_conns;
+  double seconds;
+  unsigned requests_per_conn; /* 0: keep connections open */
+  pthread_barrier_t *measure; /* every thread starts measuring together */
+  /* Results */
+  int64_t connect_ns, elapsed_ns;
+  size_t connected, failed;
+  uint64_t reconnects, requests, errors, max_us;
+  uint64_t histogram[N_BUCKETS];
+};
+
+/* 0 on success or in progress, -1: failed right away */
+int start_connect(int epfd, struct worker *w, struct conn *c) {
+  struct epoll_event ev;
+  c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (c->fd < 0) {
+    c->state = DEAD;
+    return -1;
+  }
+  if (w->requests_per_conn) {
+    /* Close with a RST: no TIME_WAIT, which would run out of local ports
+     * within seconds at thousands of connections per second */
+    struct linger lin = {1, 0};
+    setsockopt(c->fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+  }
+  if (connect(c->fd, (struct sockaddr *)&w->sin, sizeof(w->sin)) < 0 &&
+      errno != EINPROGRESS) {
+    close(c->fd);
+    c->state = DEAD;
+    return -1;
+  }
+  c->state = CONNECTING;
+  c->seq = 0;
+  ev.events = EPOLLIN | EPOLLOUT;
+  ev.data.ptr = c;
+  epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+  return 0;
+}
+
+void *run(void *arg) {
+  struct worker *w = (struct worker *)arg;
+  struct epoll_event ev, events[MAX_EVENTS];
+  struct conn *conns = (struct conn *)calloc(w->n_conns, sizeof(*conns));
+  size_t next = 0, connecting = 0, i;
+  int64_t start_ns, measure_ns = 0, end_ns = 0;
+  int epfd = epoll_create1(0), n;
+
+  if (conns == NULL || epfd < 0) {
+    perror("setup");
+    exit(1);
+  }
+
+  start_ns = now_ns();
+  while (1) {
+    int64_t now = now_ns();
+
+    /* Connect phase: keep MAX_CONNECTING in flight. It ends when every
+     * connection is up or has failed, or after CONNECT_TIMEOUT_NS, then the
+     * measurement starts, once every thread is there. */
+    while (measure_ns == 0 && next < w->n_conns &&
+           connecting < MAX_CONNECTING) {
+      if (start_connect(epfd, w, &conns[next++]) == 0)
+        ++connecting;
+      else
+        ++w->failed;
+    }
+    if (measure_ns == 0 &&
+        ((next == w->n_conns && connecting == 0) ||
+         now - start_ns > CONNECT_TIMEOUT_NS)) {
+      w->connect_ns = now - start_ns;
+      pthread_barrier_wait(w->measure);
+      measure_ns = now = now_ns();
+      end_ns = now + (int64_t)(w->seconds * 1e9);
+    }
+    if (end_ns != 0 && now >= end_ns)
+      break;
+
+    n = epoll_wait(epfd, events, MAX_EVENTS, 100);
+    for (i = 0; i < (size_t)(n > 0 ? n : 0); ++i) {
+      struct conn *c = (struct conn *)events[i].data.ptr;
+      int r = 0;
+      if (c->state == CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (!c->reconnecting && measure_ns == 0)
+          --connecting;
+        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+          r = -1;
+        } else {
+          if (!c->reconnecting)
+            ++w->connected;
+          else if (measure_ns != 0)
+            ++w->reconnects;
+          ev.events = EPOLLIN;
+          ev.data.ptr = c;
+          epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+          r = send_request(c);
+        }
+      } else if (c->state == WAITING) {
+        r = read_response(c);
+        if (r == 1) {
+          /* Only requests sent during the measurement, the others may
+           * have waited for the other threads' connect phase */
+          if (measure_ns != 0 && c->sent_ns >= measure_ns) {
+            uint64_t us = (uint64_t)(now_ns() - c->sent_ns) / 1000;
+            ++w->requests;
+            ++w->histogram[bucket_of(us)];
+            if (us > w->max_us)
+              w->max_us = us;
+          }
+          if (w->requests_per_conn && c->seq >= w->requests_per_conn) {
+            close(c->fd);
+            c->reconnecting = 1;
+            r = start_connect(epfd, w, c);
+          } else {
+            r = send_request(c);
+          }
+        }
+      }
+      if (r < 0) {
+        if (c->state == CONNECTING || c->state == DEAD)
+          ++w->failed;
+        else
+          ++w->errors; /* closed by the server or a wrong reply */
+        if (c->state != DEAD)
+          close(c->fd);
+        c->state = DEAD;
+      }
+    }
+  }
+  w->elapsed_ns = now_ns() - measure_ns;
+
+  for (i = 0; i < next; ++i)
+    if (conns[i].state != DEAD)
+      close(conns[i].fd);
+  free(conns);
+  close(epfd);
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  const char *label = argc > 1 ? argv[1] : "server";
+  size_t n_conns = argc > 2 ? strtoul(argv[2], NULL, 10) : 10000;
+  double seconds = argc > 3 ? atof(argv[3]) : 10.0;
+  size_t n_threads = argc > 4 ? strtoul(argv[4], NULL, 10) : 1;
+  unsigned requests_per_conn =
+      argc > 5 ? (unsigned)strtoul(argv[5], NULL, 10) : 0;
+  const char *host = argc > 6 ? argv[6] : "127.0.0.1";
+  struct sockaddr_in sin;
+  struct rlimit rl;
+  struct worker *workers, total;
+  pthread_barrier_t measure;
+  int64_t connect_ns = 0, elapsed_ns = 0;
+  size_t t, b;
+
+  /* 10K sockets need more than the usual 1024 soft limit */
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family = AF_INET;
+  sin.sin_port = htons(PORT);
+  if (inet_pton(AF_INET, host, &sin.sin_addr) != 1) {
+    fprintf(stderr, "bad host %s\n", host);
+    return 1;
+  }
+  if (n_threads == 0)
+    n_threads = 1;
+
+  workers = (struct worker *)calloc(n_threads, sizeof(*workers));
+  if (workers == NULL) {
+    perror("setup");
+    return 1;
+  }
+  pthread_barrier_init(&measure, NULL, (unsigned)n_threads);
+  for (t = 0; t < n_threads; ++t) {
+    struct worker *w = &workers[t];
+    w->sin = sin;
+    /* The remainder goes to the first threads */
+    w->n_conns = n_conns / n_threads + (t < n_conns % n_threads);
+    w->seconds = seconds;
+    w->requests_per_conn = requests_per_conn;
+    w->measure = &measure;
+    pthread_create(&w->thread, NULL, run, w);
+  }
+
+  memset(&total, 0, sizeof(total));
+  for (t = 0; t < n_threads; ++t) {
+    struct worker *w = &workers[t];
+    pthread_join(w->thread, NULL);
+    total.connected += w->connected;
+    total.failed += w->failed;
+    total.reconnects += w->reconnects;
+    total.requests += w->requests;
+    total.errors += w->errors;
+    if (w->max_us > total.max_us)
+      total.max_us = w->max_us;
+    for (b = 0; b < N_BUCKETS; ++b)
+      total.histogram[b] += w->histogram[b];
+    if (w->connect_ns > connect_ns)
+      connect_ns = w->connect_ns;
+    if (w->elapsed_ns > elapsed_ns)
+      elapsed_ns = w->elapsed_ns;
+  }
+  pthread_barrier_destroy(&measure);
+  free(workers);
+
+  {
+    double elapsed_s = (double)elapsed_ns / 1e9;
+    /* Churn: new connections during the measurement, else the initial
+     * connect rate */
+    double conns_per_s = requests_per_conn
+                             ? total.reconnects / elapsed_s
+                             : total.connected / ((double)connect_ns / 1e9);
+    /* Both directions, every request comes back the same length */
+    double mb_per_s = total.requests * 2.0 * REQUEST_LEN / elapsed_s / 1e6;
+    printf("%-16s conns=%zu/%zu failed=%zu errors=%llu conn/s=%.0f "
+           "req/s=%.0f MB/s=%.1f p50=%lluus p90=%lluus p99=%lluus "
+           "p99.9=%lluus max=%lluus\n",
+           label, total.connected, n_conns, total.failed,
+           (unsigned long long)total.errors, conns_per_s,
+           total.requests / elapsed_s, mb_per_s,
+           (unsigned long long)percentile(total.histogram, total.requests,
+                                          50.0),
+           (unsigned long long)percentile(total.histogram, total.requests,
+                                          90.0),
+           (unsigned long long)percentile(total.histogram, total.requests,
+                                          99.0),
+           (unsigned long long)percentile(total.histogram, total.requests,
+                                          99.9),
+           (unsigned long long)total.max_us);
+  }
+  return 0;
+}
@@ -0,0 +1,21 @@
+#!/usr/bin/env bash
+# Runs 5_loadgen.out against each rot13 server in turn, one output line per
+# server. Usage: ./bench.sh [connections, 10000] [seconds, 10]
+# 1_fork forks a process per connection, lower the count if that's too many
+# for the machine, or pick servers with SERVERS="3_epoll 4_libevent".
+set -u
+cd "$(dirname "$0")"
+connections=${1:-10000}
+seconds=${2:-10}
+ulimit -n "$(ulimit -Hn)"
+
+for server in ${SERVERS:-1_fork 2_select 3_epoll 4_libevent}; do
+  # Own session, so that killing the group also kills 1_fork's children
+  setsid "./$server.out" &
+  pid=$!
+  sleep 0.5
+  ./5_loadgen.out "$server" "$connections" "$seconds"
+  kill -- "-$pid" 2>/dev/null
+  wait "$pid" 2>/dev/null
+  sleep 1 # let the port's connections close before the next server binds
+done
@@ -0,0 +1,94 @@
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+/* A growable byte ring buffer for per-connection data. The capacity is a
+ * power of two and head/tail are free-running counters, so the used size is
+ * always tail - head and positions wrap with a mask. Reads and writes go
+ * straight between the socket and the ring through two iovecs, there is no
+ * staging copy. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#define RINGBUF_INITIAL_SIZE 4096
+
+struct ringbuf {
+  char *data;
+  size_t size; /* a power of two, 0 until the first reserve */
+  uint64_t head; /* first byte not consumed yet */
+  uint64_t tail; /* one past the last byte */
+};
+
+static inline size_t ringbuf_used(const struct ringbuf *rb) {
+  return (size_t)(rb->tail - rb->head);
+}
+
+/* ringbuf_free: back to empty with no memory, positions restart at 0 */
+static inline void ringbuf_free(struct ringbuf *rb) {
+  free(rb->data);
+  memset(rb, 0, sizeof(*rb));
+}
+
+/* ringbuf_reserve: make room for at least n more bytes, doubling the size as
+ * needed. head and tail don't change, so positions the caller keeps (like
+ * "end of the last complete line") stay valid. 0 on success, -1 if out of
+ * memory. */
+static inline int ringbuf_reserve(struct ringbuf *rb, size_t n) {
+  size_t used = ringbuf_used(rb);
+  size_t size = rb->size ? rb->size : RINGBUF_INITIAL_SIZE;
+  char *data;
+  uint64_t pos;
+  if (used + n <= rb->size)
+    return 0;
+  while (size < used + n)
+    size *= 2;
+  data = (char *)malloc(size);
+  if (data == NULL)
+    return -1;
+  /* Every byte goes to its position modulo the new size, in at most three
+   * pieces as either side can wrap */
+  for (pos = rb->head; pos < rb->tail;) {
+    size_t from = (size_t)(pos & (rb->size - 1));
+    size_t to = (size_t)(pos & (size - 1));
+    size_t chunk = (size_t)(rb->tail - pos);
+    if (chunk > rb->size - from)
+      chunk = rb->size - from;
+    if (chunk > size - to)
+      chunk = size - to;
+    memcpy(data + to, rb->data + from, chunk);
+    pos += chunk;
+  }
+  free(rb->data);
+  rb->data = data;
+  rb->size = size;
+  return 0;
+}
+
+/* ringbuf_segments: the (up to two) contiguous pieces of n bytes starting
+ * at position pos, returns how many iovecs were filled. */
+static inline int ringbuf_segments(const struct ringbuf *rb, uint64_t pos,
+                                   size_t n, struct iovec iov[2]) {
+  size_t offset = (size_t)(pos & (rb->size - 1));
+  size_t first = rb->size - offset;
+  if (n == 0)
+    return 0;
+  iov[0].iov_base = rb->data + offset;
+  if (first >= n) {
+    iov[0].iov_len = n;
+    return 1;
+  }
+  iov[0].iov_len = first;
+  iov[1].iov_base = rb->data;
+  iov[1].iov_len = n - first;
+  return 2;
+}
+
+/* ringbuf_free_space: iovecs covering all the free space after tail */
+static inline int ringbuf_free_space(const struct ringbuf *rb,
+                                     struct iovec iov[2]) {
+  return ringbuf_segments(rb, rb->tail, rb->size - ringbuf_used(rb), iov);
+}
+
+#endif /* RINGBUF_H */
@@ -0,0 +1,102 @@
+#ifndef ROT13_H
+#define ROT13_H
+
+/* rot13 of a whole buffer in place. On x86-64: AVX2 when the CPU has it
+ * (checked once at run time), 32 bytes per iteration, otherwise SSE2, 16
+ * bytes, which every x86-64 CPU has. A scalar loop does the tail and other
+ * architectures.
+ *
+ * The vector version handles both cases at once: c | 0x20 maps 'A'-'Z' onto
+ * 'a'-'z', so two compares tell whether a byte is a letter and one whether
+ * it's in the first half of the alphabet; the blend of +13 and -13 by that
+ * mask, ANDed with the letter mask, is added to every byte. Bytes >= 0x80
+ * are negative in the signed compares and never match. */
+
+#include <stddef.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+static inline char rot13_char(char c) {
+  /* We don't want to use isalpha here; setting the locale would change
+   * which characters are considered alphabetical. */
+  if ((c >= 'a' && c <= 'm') || (c >= 'A' && c <= 'M'))
+    return c + 13;
+  else if ((c >= 'n' && c <= 'z') || (c >= 'N' && c <= 'Z'))
+    return c - 13;
+  else
+    return c;
+}
+
+static inline void rot13_scalar(char *buf, size_t len) {
+  size_t i;
+  for (i = 0; i < len; ++i)
+    buf[i] = rot13_char(buf[i]);
+}
+
+#if defined(__x86_64__)
+
+static inline void rot13_sse2(char *buf, size_t len) {
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i before_a = _mm_set1_epi8('a' - 1);
+  const __m128i after_z = _mm_set1_epi8('z' + 1);
+  const __m128i after_m = _mm_set1_epi8('m' + 1);
+  const __m128i plus13 = _mm_set1_epi8(13);
+  const __m128i minus13 = _mm_set1_epi8(-13);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)(buf + i));
+    __m128i lower = _mm_or_si128(c, case_bit);
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                                   _mm_cmpgt_epi8(after_z, lower));
+    __m128i first_half = _mm_cmpgt_epi8(after_m, lower);
+    /* No blendv before SSE4.1: and/andnot/or */
+    __m128i delta = _mm_or_si128(_mm_and_si128(first_half, plus13),
+                                 _mm_andnot_si128(first_half, minus13));
+    c = _mm_add_epi8(c, _mm_and_si128(delta, letter));
+    _mm_storeu_si128((__m128i *)(buf + i), c);
+  }
+  rot13_scalar(buf + i, len - i);
+}
+
+__attribute__((target("avx2"))) static inline void rot13_avx2(char *buf,
+                                                              size_t len) {
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  const __m256i before_a = _mm256_set1_epi8('a' - 1);
+  const __m256i after_z = _mm256_set1_epi8('z' + 1);
+  const __m256i after_m = _mm256_set1_epi8('m' + 1);
+  const __m256i plus13 = _mm256_set1_epi8(13);
+  const __m256i minus13 = _mm256_set1_epi8(-13);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)(buf + i));
+    __m256i lower = _mm256_or_si256(c, case_bit);
+    __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, before_a),
+                                      _mm256_cmpgt_epi8(after_z, lower));
+    __m256i first_half = _mm256_cmpgt_epi8(after_m, lower);
+    __m256i delta = _mm256_blendv_epi8(minus13, plus13, first_half);
+    c = _mm256_add_epi8(c, _mm256_and_si256(delta, letter));
+    _mm256_storeu_si256((__m256i *)(buf + i), c);
+  }
+  /* At most 31 left, one SSE2 step and the scalar tail */
+  rot13_sse2(buf + i, len - i);
+}
+
+static inline void rot13_buffer(char *buf, size_t len) {
+  /* A load and a bit test, libgcc fills in the CPU model at startup */
+  if (__builtin_cpu_supports("avx2"))
+    rot13_avx2(buf, len);
+  else
+    rot13_sse2(buf, len);
+}
+
+#else
+
+static inline void rot13_buffer(char *buf, size_t len) {
+  rot13_scalar(buf, len);
+}
+
+#endif
+
+#endif /* ROT13_H */
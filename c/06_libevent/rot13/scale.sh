@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+# How 3_epoll and 4_libevent scale with one event loop per core (SO_REUSEPORT
+# listeners): for 1, 2, 4, ... up to the number of cores, runs the server
+# with that many loops and the load generator with as many threads, twice:
+# - keep-alive: connections stay open, req/s and MB/s are the IO throughput
+# - churn: a new connection every REQUESTS_PER_CONN requests, conn/s is the
+#   accept throughput
+# Usage: ./scale.sh [connections, 10000] [seconds, 10]
+set -u
+cd "$(dirname "$0")"
+connections=${1:-10000}
+seconds=${2:-10}
+requests_per_conn=${REQUESTS_PER_CONN:-1}
+cores=$(nproc)
+ulimit -n "$(ulimit -Hn)"
+
+loops=1
+while true; do
+  for server in 3_epoll 4_libevent; do
+    for mode in keep-alive churn; do
+      rpc=0
+      [ "$mode" = churn ] && rpc=$requests_per_conn
+      "./$server.out" "$loops" &
+      pid=$!
+      sleep 0.5
+      ./5_loadgen.out "$server x$loops $mode" "$connections" "$seconds" \
+        "$loops" "$rpc"
+      kill "$pid" 2>/dev/null
+      wait "$pid" 2>/dev/null
+      sleep 1
+    done
+  done
+  [ "$loops" -ge "$cores" ] && break
+  loops=$((loops * 2))
+  [ "$loops" -gt "$cores" ] && loops=$cores
+done
@@ -3,80 +3,248 @@
 #include <benchmark/benchmark.h>
 
 #include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 #include <stdexcept>
 #include <random>
+#include <string>
+#include <vector>
 
-std::vector<int64_t> generate_random_values(size_t size) {
-    static std::mt19937 gen(std::random_device{}());
-    std::uniform_int_distribution<int64_t> dist(INT64_MIN, INT64_MAX);
+// The values each benchmark cycles through, by Arg:
+// 0: small prices, e.g. in ticks or cents, mostly 1 to 6 digits
+// 1: nanosecond timestamps, 19 digits, increasing
+// 2: full int64 range, uniformly random, almost always 18 or 19 digits
+enum Distribution { small_prices = 0, timestamps = 1, full_range = 2 };
 
+std::vector<int64_t> generate_values(Distribution distribution, size_t size) {
+    static std::mt19937_64 gen(std::random_device{}());
     std::vector<int64_t> values(size);
-    for (size_t i = 0; i < size; ++i) {
-        values[i] = dist(gen);
+    switch (distribution) {
+        case small_prices: {
+            // Log-uniform, so each digit count is about as likely
+            std::uniform_real_distribution<double> exponent(0.0, 6.0);
+            for (auto &value: values)
+                value = static_cast<int64_t>(std::pow(10.0, exponent(gen)));
+            break;
+        }
+        case timestamps: {
+            // 2025-01-01T00:00:00Z onwards, 0 to 10 us apart
+            int64_t ts = 1'735'689'600'000'000'000;
+            std::uniform_int_distribution<int64_t> step(0, 10'000);
+            for (auto &value: values)
+                value = ts += step(gen);
+            break;
+        }
+        case full_range: {
+            std::uniform_int_distribution<int64_t> dist(INT64_MIN, INT64_MAX);
+            for (auto &value: values)
+                value = dist(gen);
+            // Plus the edge cases
+            values.insert(values.end(), {0, 1, -1, INT64_MAX, INT64_MIN});
+            break;
+        }
     }
     return values;
 }
 
-std::vector random_values = generate_random_values(1000);
+const std::vector<int64_t> &values_for(const benchmark::State &state) {
+    static const std::vector<int64_t> values[] = {
+            generate_values(small_prices, 1000),
+            generate_values(timestamps, 1000),
+            generate_values(full_range, 1000)};
+    return values[state.range(0)];
+}
+
+static void std_to_chars(int64_t in, char *buffer) {
+    auto result = std::to_chars(buffer, buffer + BUFFER_SIZE, in);
+    if (result.ec != std::errc()) {
+        throw std::logic_error("");
+    }
+}
+
+static void my_int64_to_char_v4(int64_t in, char *buffer) {
+    int64_to_char_v4(in, buffer);
+}
+
+static void my_int64_to_char_v5(int64_t in, char *buffer) {
+    int64_to_char_v5(in, buffer);
+}
 
-static void BM_std_to_chars(benchmark::State &state) {
+// One value per iteration, cycling through the distribution
+template<void (*CONVERT)(int64_t, char *)>
+static void BM_convert(benchmark::State &state) {
+    const auto &values = values_for(state);
     size_t iter = 0;
     for (auto _: state) {
         char buffer[BUFFER_SIZE] = {0};
-        auto result = std::to_chars(buffer, buffer + sizeof(buffer),
-                                    random_values[iter % random_values.size()]);
+        CONVERT(values[iter++ % values.size()], buffer);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
 
-        if (result.ec == std::errc()) {
-        } else {
-            throw std::logic_error("");
+#define CONVERT_BENCHMARK(CONVERT)                                             \
+    BENCHMARK_TEMPLATE(BM_convert, CONVERT)                                    \
+            ->ArgName("distribution")                                          \
+            ->DenseRange(small_prices, full_range)
+
+CONVERT_BENCHMARK(std_to_chars);
+CONVERT_BENCHMARK(int64_to_char_v1);
+CONVERT_BENCHMARK(int64_to_char_v2);
+CONVERT_BENCHMARK(int64_to_char_v3);
+CONVERT_BENCHMARK(my_int64_to_char_v4);
+CONVERT_BENCHMARK(my_int64_to_char_v5);
+
+// A whole distribution into one CSV line per iteration
+static void BM_batch_std_to_chars(benchmark::State &state) {
+    const auto &values = values_for(state);
+    std::vector<char> out(values.size() * BUFFER_SIZE);
+    for (auto _: state) {
+        char *p = out.data();
+        for (const auto &value: values) {
+            p = std::to_chars(p, p + BUFFER_SIZE, value).ptr;
+            *p++ = ',';
         }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
     }
+    state.SetItemsProcessed(state.iterations() * values.size());
 }
 
-BENCHMARK(BM_std_to_chars);
+BENCHMARK(BM_batch_std_to_chars)
+        ->ArgName("distribution")
+        ->DenseRange(small_prices, full_range);
 
-static void BM_my_int64_to_char_v1(benchmark::State &state) {
+static void BM_batch_int64_to_chars(benchmark::State &state) {
+    const auto &values = values_for(state);
+    std::vector<char> out(values.size() * BUFFER_SIZE);
     for (auto _: state) {
-        size_t iter = 0;
-        char buffer[BUFFER_SIZE] = {0};
-        int64_to_char_v1(random_values[iter % random_values.size()], buffer);
+        benchmark::DoNotOptimize(int64_to_chars_batch(
+                values.data(), values.size(), ',', out.data()));
+        benchmark::ClobberMemory();
     }
+    state.SetItemsProcessed(state.iterations() * values.size());
 }
 
-BENCHMARK(BM_my_int64_to_char_v1);
+BENCHMARK(BM_batch_int64_to_chars)
+        ->ArgName("distribution")
+        ->DenseRange(small_prices, full_range);
+
+
+// Parsing, the same distributions as text. Doubles are prices with 2 or 4
+// decimals, timestamps as seconds with 9 decimals and, for the full range,
+// random doubles printed with 17 significant digits.
+const std::vector<std::string> &int64_texts_for(const benchmark::State &state) {
+    static const auto texts = [] {
+        std::vector<std::vector<std::string>> texts;
+        for (auto distribution: {small_prices, timestamps, full_range}) {
+            texts.emplace_back();
+            for (const auto &value: generate_values(distribution, 1000))
+                texts.back().push_back(std::to_string(value));
+        }
+        return texts;
+    }();
+    return texts[state.range(0)];
+}
 
-static void BM_my_int64_to_char_v2(benchmark::State &state) {
-    for (auto _: state) {
-        size_t iter = 0;
-        char buffer[BUFFER_SIZE] = {0};
-        int64_to_char_v2(random_values[iter % random_values.size()], buffer);
-    }
+const std::vector<std::string> &
+double_texts_for(const benchmark::State &state) {
+    static const auto texts = [] {
+        std::vector<std::vector<std::string>> texts(3);
+        char buffer[64];
+        for (const auto &value: generate_values(small_prices, 1000)) {
+            snprintf(buffer, sizeof(buffer), value % 2 ? "%.2f" : "%.4f",
+                     static_cast<double>(value) / 100);
+            texts[small_prices].push_back(buffer);
+        }
+        for (const auto &value: generate_values(timestamps, 1000)) {
+            snprintf(buffer, sizeof(buffer), "%lld.%09lld",
+                     static_cast<long long>(value / 1'000'000'000),
+                     static_cast<long long>(value % 1'000'000'000));
+            texts[timestamps].push_back(buffer);
+        }
+        std::mt19937_64 gen(std::random_device{}());
+        while (texts[full_range].size() < 1000) {
+            const uint64_t bits = gen();
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            if (std::isfinite(d)) {
+                snprintf(buffer, sizeof(buffer), "%.17g", d);
+                texts[full_range].push_back(buffer);
+            }
+        }
+        return texts;
+    }();
+    return texts[state.range(0)];
+}
+
+static int64_t parse_strtoll(const std::string &text) {
+    return strtoll(text.c_str(), nullptr, 10);
+}
+
+static int64_t parse_from_chars_int64(const std::string &text) {
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+static int64_t parse_char_to_int64(const std::string &text) {
+    int64_t value = 0;
+    char_to_int64(text.data(), text.data() + text.size(), &value);
+    return value;
+}
+
+static double parse_atof(const std::string &text) {
+    return atof(text.c_str());
 }
 
-BENCHMARK(BM_my_int64_to_char_v2);
+static double parse_strtod(const std::string &text) {
+    return strtod(text.c_str(), nullptr);
+}
+
+static double parse_from_chars_double(const std::string &text) {
+    double value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+static double parse_char_to_double(const std::string &text) {
+    double value = 0;
+    char_to_double(text.data(), text.data() + text.size(), &value);
+    return value;
+}
 
-static void BM_my_int64_to_char_v3(benchmark::State &state) {
+template<class T, T (*PARSE)(const std::string &),
+         const std::vector<std::string> &(*TEXTS)(const benchmark::State &)>
+static void BM_parse(benchmark::State &state) {
+    const auto &texts = TEXTS(state);
+    size_t iter = 0;
     for (auto _: state) {
-        size_t iter = 0;
-        char buffer[BUFFER_SIZE] = {0};
-        int64_to_char_v3(random_values[iter % random_values.size()], buffer);
+        benchmark::DoNotOptimize(PARSE(texts[iter++ % texts.size()]));
     }
+    state.SetItemsProcessed(state.iterations());
 }
 
-BENCHMARK(BM_my_int64_to_char_v3);
+#define PARSE_BENCHMARK(T, PARSE, TEXTS)                                       \
+    BENCHMARK_TEMPLATE(BM_parse, T, PARSE, TEXTS)                              \
+            ->ArgName("distribution")                                          \
+            ->DenseRange(small_prices, full_range)
 
+PARSE_BENCHMARK(int64_t, parse_strtoll, int64_texts_for);
+PARSE_BENCHMARK(int64_t, parse_from_chars_int64, int64_texts_for);
+PARSE_BENCHMARK(int64_t, parse_char_to_int64, int64_texts_for);
+PARSE_BENCHMARK(double, parse_atof, double_texts_for);
+PARSE_BENCHMARK(double, parse_strtod, double_texts_for);
+PARSE_BENCHMARK(double, parse_from_chars_double, double_texts_for);
+PARSE_BENCHMARK(double, parse_char_to_double, double_texts_for);
 
-int main(int argc, char **argv) {
-
-    random_values.push_back(0);
-    random_values.push_back(1);
-    random_values.push_back(-1);
-    random_values.push_back(INT64_MAX);
-    random_values.push_back(INT64_MIN);
 
+int main(int argc, char **argv) {
     ::benchmark::Initialize(&argc, argv);
     ::benchmark::RunSpecifiedBenchmarks();
 
     return 0;
 }
-// BENCHMARK_MAIN();
\ No newline at end of file
+// BENCHMARK_MAIN();
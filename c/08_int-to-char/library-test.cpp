@@ -4,6 +4,12 @@
 
 #include <random>
 #include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <vector>
 
 TEST(LibraryTest, Simple) {
     char buffer0[BUFFER_SIZE];
@@ -20,7 +26,7 @@ TEST(LibraryTest, Simple) {
                                     value);
         int64_to_char_v1(value, buffer1);
         int64_to_char_v2(value, buffer2);
-        int64_to_char_v2(value, buffer3);
+        int64_to_char_v3(value, buffer3);
         if (result.ec != std::errc()) {
             throw std::logic_error("");
         }
@@ -100,4 +106,269 @@ TEST(LibraryTest, EdgeCases) {
         EXPECT_EQ(strcmp(buffer0, buffer3), 0) << "buffer3: " << buffer3;
     }
 
-}
\ No newline at end of file
+}
+
+// Compares every version against std::to_chars for one value
+static void expect_all_versions_match(int64_t value) {
+    char expected[BUFFER_SIZE] = {0};
+    auto result = std::to_chars(expected, expected + BUFFER_SIZE, value);
+    if (result.ec != std::errc()) {
+        throw std::logic_error("");
+    }
+    const size_t expected_len = result.ptr - expected;
+
+    char buffer[BUFFER_SIZE];
+    void (*const void_versions[])(int64_t, char *) = {
+            int64_to_char_v1, int64_to_char_v2, int64_to_char_v3};
+    for (size_t v = 0; v < std::size(void_versions); ++v) {
+        memset(buffer, 0, BUFFER_SIZE);
+        void_versions[v](value, buffer);
+        EXPECT_STREQ(buffer, expected) << "v" << v + 1;
+    }
+
+    // v4 and v5 terminate the string themselves
+    memset(buffer, 'x', BUFFER_SIZE);
+    EXPECT_EQ(int64_to_char_v4(value, buffer), expected_len);
+    EXPECT_STREQ(buffer, expected) << "v4";
+    memset(buffer, 'x', BUFFER_SIZE);
+    EXPECT_EQ(int64_to_char_v5(value, buffer), expected_len);
+    EXPECT_STREQ(buffer, expected) << "v5";
+}
+
+// log10() of a double is inexact next to powers of ten, which v2 used to
+// trust, e.g. 999999999999999999 has 18 digits but rounds to 1e18
+TEST(LibraryTest, PowersOfTen) {
+    int64_t power = 1;
+    for (int exponent = 0; exponent <= 18; ++exponent) {
+        for (int64_t value: {power - 1, power, power + 1}) {
+            expect_all_versions_match(value);
+            expect_all_versions_match(-value);
+        }
+        if (exponent < 18)
+            power *= 10;
+    }
+}
+
+TEST(LibraryTest, FullRangeRandom) {
+    constexpr size_t test_count = 1'000'000;
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<int64_t> dist(INT64_MIN, INT64_MAX);
+    // Also every digit count, by shifting the value down
+    std::uniform_int_distribution<int> shift(0, 63);
+    for (size_t i = 0; i < test_count; ++i) {
+        expect_all_versions_match(dist(gen) >> shift(gen));
+    }
+}
+
+TEST(LibraryTest, V4V5EdgeCases) {
+    for (int64_t value: {int64_t{0}, int64_t{1}, int64_t{-1}, int64_t{9},
+                         int64_t{10}, int64_t{99}, int64_t{100}, int64_t{-100},
+                         INT64_MAX, INT64_MIN, INT64_MIN + 1}) {
+        expect_all_versions_match(value);
+    }
+}
+
+TEST(LibraryTest, Batch) {
+    std::vector<int64_t> values = {0,         -1,        42,       -1234567,
+                                   INT64_MAX, INT64_MIN, 99999999, 100000000};
+    std::string expected_csv;
+    std::string expected_lines;
+    for (const auto &value: values) {
+        expected_csv += std::to_string(value) + ",";
+        expected_lines += std::to_string(value) + "\n";
+    }
+
+    std::vector<char> out(values.size() * BUFFER_SIZE);
+    size_t len = int64_to_chars_batch(values.data(), values.size(), ',',
+                                      out.data());
+    EXPECT_EQ(std::string(out.data(), len), expected_csv);
+    len = int64_to_chars_batch(values.data(), values.size(), '\n',
+                               out.data());
+    EXPECT_EQ(std::string(out.data(), len), expected_lines);
+    EXPECT_EQ(int64_to_chars_batch(values.data(), 0, ',', out.data()), 0u);
+}
+
+static void expect_int64_parses(const std::string &text, int64_t expected) {
+    int64_t value = 0;
+    const char *end = char_to_int64(text.data(), text.data() + text.size(),
+                                    &value);
+    EXPECT_EQ(end, text.data() + text.size()) << text;
+    EXPECT_EQ(value, expected) << text;
+}
+
+static void expect_int64_rejected(const std::string &text) {
+    int64_t value = 42;
+    EXPECT_EQ(char_to_int64(text.data(), text.data() + text.size(), &value),
+              text.data())
+            << text;
+    EXPECT_EQ(value, 42) << text;
+}
+
+TEST(LibraryTest, CharToInt64EdgeCases) {
+    expect_int64_parses("0", 0);
+    expect_int64_parses("-0", 0);
+    expect_int64_parses("7", 7);
+    expect_int64_parses("-7", -7);
+    expect_int64_parses("12345678", 12345678);
+    expect_int64_parses("123456789", 123456789);
+    expect_int64_parses("9223372036854775807", INT64_MAX);
+    expect_int64_parses("-9223372036854775808", INT64_MIN);
+    expect_int64_parses("00000000000000000000000000042", 42);
+    expect_int64_parses("-0000000000000000000009223372036854775808",
+                        INT64_MIN);
+
+    expect_int64_rejected("");
+    expect_int64_rejected("-");
+    expect_int64_rejected("+1");
+    expect_int64_rejected(" 1");
+    expect_int64_rejected("x1");
+    expect_int64_rejected("9223372036854775808");
+    expect_int64_rejected("-9223372036854775809");
+    expect_int64_rejected("18446744073709551616");
+    expect_int64_rejected("99999999999999999999999");
+}
+
+TEST(LibraryTest, CharToInt64StopsAtNonDigits) {
+    // The SWAR path reads 8 chars at a time, non-digits among them must end
+    // the number where they are
+    for (const char *terminator: {",", "\n", ".", ":", "/", " ", "a"}) {
+        for (int digits = 1; digits <= 19; ++digits) {
+            std::string number(digits, '9');
+            number[0] = '1';
+            const std::string text = number + terminator + "12345678";
+            int64_t value = 0;
+            const char *end = char_to_int64(
+                    text.data(), text.data() + text.size(), &value);
+            EXPECT_EQ(end, text.data() + number.size()) << text;
+            EXPECT_EQ(value, std::stoll(number)) << text;
+        }
+    }
+    // and it never reads past last
+    const char text[] = "1234567890123";
+    for (size_t len = 1; len < sizeof(text) - 1; ++len) {
+        int64_t value = 0;
+        EXPECT_EQ(char_to_int64(text, text + len, &value), text + len);
+        EXPECT_EQ(value, std::stoll(std::string(text, len)));
+    }
+}
+
+TEST(LibraryTest, CharToInt64RoundTrip) {
+    constexpr size_t test_count = 1'000'000;
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<int64_t> dist(INT64_MIN, INT64_MAX);
+    std::uniform_int_distribution<int> shift(0, 63);
+    char buffer[BUFFER_SIZE];
+    for (size_t i = 0; i < test_count; ++i) {
+        const int64_t expected = dist(gen) >> shift(gen);
+        const size_t len = int64_to_char_v5(expected, buffer);
+        int64_t value = 0;
+        EXPECT_EQ(char_to_int64(buffer, buffer + len, &value), buffer + len);
+        ASSERT_EQ(value, expected) << buffer;
+    }
+}
+
+// Bitwise against strtod(), which rounds correctly
+static void expect_double_matches_strtod(const std::string &text) {
+    const double expected = strtod(text.c_str(), nullptr);
+    double value = 0;
+    const char *end = char_to_double(text.data(), text.data() + text.size(),
+                                     &value);
+    EXPECT_EQ(end, text.data() + text.size()) << text;
+    uint64_t expected_bits, value_bits;
+    memcpy(&expected_bits, &expected, sizeof(expected));
+    memcpy(&value_bits, &value, sizeof(value));
+    EXPECT_EQ(value_bits, expected_bits)
+            << text << ": " << value << " != " << expected;
+}
+
+TEST(LibraryTest, CharToDoubleEdgeCases) {
+    for (const char *text: {
+                 "0", "-0", "0.0", "1", "-1", "1.5", "0.1", "0.3", "3.1415",
+                 "1e0", "1E+2", "1e-2", "123.456e7", "5e-324", "4.9e-324",
+                 "2.4703282292062327e-324", // rounds to 0
+                 "2.4703282292062328e-324", // rounds up to 5e-324
+                 "2.2250738585072011e-308", // largest subnormal
+                 "2.2250738585072014e-308", // smallest normal
+                 "1.7976931348623157e308", "1.7976931348623159e308", // inf
+                 "1e309", "-1e400", "1e-400",
+                 "9007199254740993", // 2^53 + 1, halfway: to even
+                 "9007199254740995", "18014398509481985",
+                 "123456789012345678", "1234567890123456789",
+                 "0.000000000000000000000000000001234567890123456789",
+                 // More than 19 significant digits
+                 "12345678901234567890", "3.14159265358979323846264338327950",
+                 "0.1000000000000000055511151231257827021181583404541015625",
+                 "1.00000000000000011102230246251565404236316680908203125",
+                 "0000000000000000000000001.5", "1.5000000000000000000000000",
+                 "1e00000000000000000000000000000000001",
+                 "1e-99999999999999999999"}) {
+        expect_double_matches_strtod(text);
+    }
+}
+
+TEST(LibraryTest, CharToDoubleRejects) {
+    for (const char *text: {"", "-", ".", "-.", "e5", "+1", " 1", "inf",
+                            "nan", "x"}) {
+        double value = 42;
+        EXPECT_EQ(char_to_double(text, text + strlen(text), &value), text)
+                << text;
+        EXPECT_EQ(value, 42) << text;
+    }
+    // "1e" and "1e+" are 1 followed by something else, like strtod() says
+    for (const char *text: {"1e", "1e+", "1ex", "1.", "1.x"}) {
+        double value = 0;
+        char *strtod_end;
+        const double expected = strtod(text, &strtod_end);
+        EXPECT_EQ(char_to_double(text, text + strlen(text), &value),
+                  strtod_end)
+                << text;
+        EXPECT_EQ(value, expected) << text;
+    }
+}
+
+TEST(LibraryTest, CharToDoubleRandomBits) {
+    // Every kind of double, printed shortest and with 17 digits
+    constexpr size_t test_count = 1'000'000;
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    char buffer[64];
+    for (size_t i = 0; i < test_count; ++i) {
+        const uint64_t bits = gen();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        if (!std::isfinite(d))
+            continue;
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), d);
+        expect_double_matches_strtod(std::string(buffer, result.ptr));
+        snprintf(buffer, sizeof(buffer), "%.17g", d);
+        expect_double_matches_strtod(buffer);
+    }
+}
+
+TEST(LibraryTest, CharToDoubleRandomDecimals) {
+    // Prices and quantities as they appear in market data: a few digits on
+    // each side of the point, sometimes an exponent
+    constexpr size_t test_count = 1'000'000;
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<int> digit_count(0, 12);
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    for (size_t i = 0; i < test_count; ++i) {
+        std::string text = gen() & 1 ? "-" : "";
+        const int int_digits = digit_count(gen) + 1;
+        for (int d = 0; d < int_digits; ++d)
+            text += static_cast<char>('0' + digit(gen));
+        const int frac_digits = digit_count(gen);
+        if (frac_digits > 0) {
+            text += '.';
+            for (int d = 0; d < frac_digits; ++d)
+                text += static_cast<char>('0' + digit(gen));
+        }
+        if (gen() % 4 == 0)
+            text += "e" + std::to_string(exponent(gen));
+        expect_double_matches_strtod(text);
+    }
+}
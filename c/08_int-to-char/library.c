@@ -1,9 +1,38 @@
 #include "library.h"
+#include "power_of_five.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// powers_of_10[i] == 10^i, for every power that fits in uint64_t
+static const uint64_t powers_of_10[20] = {
+        1ULL,
+        10ULL,
+        100ULL,
+        1000ULL,
+        10000ULL,
+        100000ULL,
+        1000000ULL,
+        10000000ULL,
+        100000000ULL,
+        1000000000ULL,
+        10000000000ULL,
+        100000000000ULL,
+        1000000000000ULL,
+        10000000000000ULL,
+        100000000000000ULL,
+        1000000000000000ULL,
+        10000000000000000ULL,
+        100000000000000000ULL,
+        1000000000000000000ULL,
+        10000000000000000000ULL};
+
 void int64_to_char_v1(int64_t in, char *buffer) {
     if (in == 0) {
         buffer[0] = '0';
@@ -45,6 +74,12 @@ void int64_to_char_v2(int64_t in, char *buffer) {
     uint64_t abs_in = is_negative ? ((uint64_t) (-(in + 1)) + 1)
                                   : (uint64_t) in;
     size_t digit = (size_t) log10((double) abs_in) + 1;
+    // abs_in rounds to the nearest double, e.g. 10^18 - 1 becomes 10^18, so
+    // log10() is only a guess near powers of ten, correct it by one either way
+    if (digit < 20 && abs_in >= powers_of_10[digit])
+        ++digit;
+    else if (abs_in < powers_of_10[digit - 1])
+        --digit;
 
     if (is_negative) {
         digit++;
@@ -115,4 +150,398 @@ void int64_to_char_v3(int64_t in, char *buffer) {
         --digit;
         abs_in /= 10;
     }
-}
\ No newline at end of file
+}
+
+// "00" "01" ... "99", two digits per lookup halves the divisions
+static const char digit_pairs[200] = {
+        '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6',
+        '0', '7', '0', '8', '0', '9', '1', '0', '1', '1', '1', '2', '1', '3',
+        '1', '4', '1', '5', '1', '6', '1', '7', '1', '8', '1', '9', '2', '0',
+        '2', '1', '2', '2', '2', '3', '2', '4', '2', '5', '2', '6', '2', '7',
+        '2', '8', '2', '9', '3', '0', '3', '1', '3', '2', '3', '3', '3', '4',
+        '3', '5', '3', '6', '3', '7', '3', '8', '3', '9', '4', '0', '4', '1',
+        '4', '2', '4', '3', '4', '4', '4', '5', '4', '6', '4', '7', '4', '8',
+        '4', '9', '5', '0', '5', '1', '5', '2', '5', '3', '5', '4', '5', '5',
+        '5', '6', '5', '7', '5', '8', '5', '9', '6', '0', '6', '1', '6', '2',
+        '6', '3', '6', '4', '6', '5', '6', '6', '6', '7', '6', '8', '6', '9',
+        '7', '0', '7', '1', '7', '2', '7', '3', '7', '4', '7', '5', '7', '6',
+        '7', '7', '7', '8', '7', '9', '8', '0', '8', '1', '8', '2', '8', '3',
+        '8', '4', '8', '5', '8', '6', '8', '7', '8', '8', '8', '9', '9', '0',
+        '9', '1', '9', '2', '9', '3', '9', '4', '9', '5', '9', '6', '9', '7',
+        '9', '8', '9', '9'};
+
+// Number of decimal digits of x, without branches: bit width * log10(2)
+// (1233 / 4096) is either right or one too many, the comparison fixes it.
+// x | 1 counts 0 as 1 digit and doesn't change the result for any other x.
+static size_t count_digits(uint64_t x) {
+    x |= 1;
+    const size_t bits = 64 - (size_t) __builtin_clzll(x);
+    const size_t guess = (bits * 1233) >> 12;
+    return guess + 1 - (x < powers_of_10[guess]);
+}
+
+static uint64_t abs_int64(int64_t in) {
+    // Introduction of uint64_t is important, as -1 * INT64_MIN > INT64_MAX!
+    return in < 0 ? ((uint64_t) (-(in + 1)) + 1) : (uint64_t) in;
+}
+
+// Writes the digits of x ending at end (exclusive), two at a time
+static void write_digit_pairs(uint64_t x, char *end) {
+    while (x >= 100) {
+        const uint64_t pair = x % 100;
+        x /= 100;
+        end -= 2;
+        memcpy(end, &digit_pairs[pair * 2], 2);
+    }
+    if (x >= 10) {
+        memcpy(end - 2, &digit_pairs[x * 2], 2);
+    } else {
+        end[-1] = (char) ('0' + x);
+    }
+}
+
+static size_t write_int64_v4(int64_t in, char *buffer) {
+    const int is_negative = (in < 0);
+    const uint64_t abs_in = abs_int64(in);
+    const size_t len = count_digits(abs_in) + is_negative;
+    buffer[0] = '-';
+    write_digit_pairs(abs_in, buffer + len);
+    return len;
+}
+
+size_t int64_to_char_v4(int64_t in, char *buffer) {
+    const size_t len = write_int64_v4(in, buffer);
+    buffer[len] = '\0';
+    return len;
+}
+
+#ifdef __SSE2__
+// The 8 digits of x < 10^8 as 8 uint16 lanes, most significant first. Splits
+// x into abcd and efgh, broadcasts each to four lanes and divides the lanes
+// by 1000, 100, 10 and 1 with fixed-point multiplies, giving a, ab, abc, abcd;
+// subtracting 10 times the lane before leaves a, b, c, d.
+static __m128i eight_digits_sse2(uint32_t x) {
+    const __m128i abcdefgh = _mm_cvtsi32_si128((int) x);
+    // abcd = x / 10000 as (x * ceil(2^45 / 10000)) >> 45
+    const __m128i abcd = _mm_srli_epi64(
+            _mm_mul_epu32(abcdefgh, _mm_set1_epi32((int) 0xd1b71759)), 45);
+    const __m128i efgh = _mm_sub_epi32(
+            abcdefgh, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+
+    // [abcd * 4, efgh * 4] broadcast to [abcd * 4 x4, efgh * 4 x4]
+    const __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+    const __m128i v2 = _mm_unpacklo_epi32(_mm_unpacklo_epi16(v1, v1),
+                                          _mm_unpacklo_epi16(v1, v1));
+
+    // [a, ab, abc, abcd, e, ef, efg, efgh]
+    const __m128i div_powers = _mm_setr_epi16(8389, 5243, 13108, (short) 32768,
+                                              8389, 5243, 13108, (short) 32768);
+    const __m128i shift_powers =
+            _mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, (short) (1 << 15), 1 << 7,
+                           1 << 11, 1 << 13, (short) (1 << 15));
+    const __m128i prefixes =
+            _mm_mulhi_epu16(_mm_mulhi_epu16(v2, div_powers), shift_powers);
+
+    // [a, b, c, d, e, f, g, h]
+    const __m128i tens = _mm_slli_epi64(
+            _mm_mullo_epi16(prefixes, _mm_set1_epi16(10)), 16);
+    return _mm_sub_epi16(prefixes, tens);
+}
+
+// Writes the 16 digits of x < 10^16, leading zeros included, with one store
+static void sixteen_digits_sse2(uint64_t x, char *out) {
+    const __m128i hi = eight_digits_sse2((uint32_t) (x / 100000000));
+    const __m128i lo = eight_digits_sse2((uint32_t) (x % 100000000));
+    const __m128i digits = _mm_add_epi8(_mm_packus_epi16(hi, lo),
+                                        _mm_set1_epi8('0'));
+    _mm_storeu_si128((__m128i *) out, digits);
+}
+
+static size_t write_int64_v5(int64_t in, char *buffer) {
+    const int is_negative = (in < 0);
+    const uint64_t abs_in = abs_int64(in);
+    // Up to 4 digits, two table lookups beat two 8-digit conversions
+    if (abs_in < 10000)
+        return write_int64_v4(in, buffer);
+
+    const size_t digits = count_digits(abs_in);
+    const size_t len = digits + is_negative;
+    buffer[0] = '-';
+    if (digits <= 16) {
+        // 16 digits into scratch, then the significant ones into place
+        char scratch[16];
+        sixteen_digits_sse2(abs_in, scratch);
+        memcpy(buffer + is_negative, scratch + 16 - digits, digits);
+    } else {
+        // At most 4 leading digits (UINT64_MAX / 10^16 < 10^4), then 16
+        const uint64_t lead = abs_in / 10000000000000000ULL;
+        char *tail = buffer + len - 16;
+        write_digit_pairs(lead, tail);
+        sixteen_digits_sse2(abs_in % 10000000000000000ULL, tail);
+    }
+    return len;
+}
+#else
+static size_t write_int64_v5(int64_t in, char *buffer) {
+    return write_int64_v4(in, buffer);
+}
+#endif
+
+size_t int64_to_char_v5(int64_t in, char *buffer) {
+    const size_t len = write_int64_v5(in, buffer);
+    buffer[len] = '\0';
+    return len;
+}
+
+size_t int64_to_chars_batch(const int64_t *in, size_t count, char separator,
+                            char *out) {
+    char *p = out;
+    for (size_t i = 0; i < count; ++i) {
+        p += write_int64_v5(in[i], p);
+        *p++ = separator;
+    }
+    return (size_t) (p - out);
+}
+
+// Parsing
+
+static int is_digit(char c) {
+    return (unsigned char) (c - '0') < 10;
+}
+
+static uint64_t load_8_chars(const char *p) {
+    uint64_t chars;
+    memcpy(&chars, p, sizeof(chars));
+    return chars;
+}
+
+// Whether all 8 chars are '0'..'9': high nibble 3 in every byte, and still
+// 3 after adding 6, which carries for ':'..'?'
+static int are_8_digits(uint64_t chars) {
+    return ((chars & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chars + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+// Value of 8 digits, first char most significant (little-endian): combines
+// neighbouring digits, then pairs, then quads with one multiply each, instead
+// of 8 multiply-adds
+static uint32_t parse_8_digits(uint64_t chars) {
+    chars = (chars & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    chars = (chars & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (uint32_t) ((chars & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >>
+                       32);
+}
+
+// Accumulates digits from *p into *value, 8 at a time while 8 are available
+// and then one at a time. Returns how many were read. Works on locals: *p and
+// *value may alias any char, so updating them in place reloads every step.
+static size_t parse_digits(const char **p, const char *last, uint64_t *value) {
+    const char *start = *p;
+    const char *q = start;
+    uint64_t v = *value;
+    while (last - q >= 8 && are_8_digits(load_8_chars(q))) {
+        v = v * 100000000 + parse_8_digits(load_8_chars(q));
+        q += 8;
+    }
+    while (q < last && is_digit(*q)) {
+        v = v * 10 + (uint64_t) (*q - '0');
+        ++q;
+    }
+    *p = q;
+    *value = v;
+    return (size_t) (q - start);
+}
+
+const char *char_to_int64(const char *first, const char *last, int64_t *out) {
+    const char *p = first;
+    const int is_negative = (p < last && *p == '-');
+    p += is_negative;
+
+    // Leading zeros don't count toward the 19 digits an int64 can have
+    const char *digits_start = p;
+    while (p < last && *p == '0')
+        ++p;
+    const int had_zeros = p > digits_start;
+
+    const char *significant = p;
+    // Up to 19 digits can't overflow uint64_t, more than 19 overflow int64_t
+    const char *limit = last - p > 19 ? p + 19 : last;
+    uint64_t value = 0;
+    parse_digits(&p, limit, &value);
+    if (p == significant && !had_zeros)
+        return first;
+    if (p < last && is_digit(*p))
+        return first;
+
+    // -INT64_MIN is one more than INT64_MAX
+    const uint64_t max = (uint64_t) INT64_MAX + (uint64_t) is_negative;
+    if (value > max)
+        return first;
+    *out = is_negative ? (int64_t) (0 - value) : (int64_t) value;
+    return p;
+}
+
+// Double parsing: decimal mantissa w (up to 19 digits) and exponent q, i.e.
+// w * 10^q, to the nearest double
+
+#define MANTISSA_EXPLICIT_BITS 52
+#define MINIMUM_EXPONENT (-1023)
+#define INFINITE_POWER 0x7FF
+
+static double to_double(uint64_t mantissa, int32_t power2, int is_negative) {
+    uint64_t bits = mantissa | (uint64_t) power2 << MANTISSA_EXPLICIT_BITS;
+    bits |= (uint64_t) is_negative << 63;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// Clinger's fast path: w and 10^|q| are both exact doubles, so one IEEE
+// multiply or divide rounds correctly. Returns 0 if it doesn't apply.
+static int clinger_fast_path(uint64_t w, int64_t q, int is_negative,
+                             double *out) {
+    static const double exact_powers_of_10[23] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (q < -22 || q > 22 || w > (1ULL << 53))
+        return 0;
+    double d = (double) w;
+    d = q < 0 ? d / exact_powers_of_10[-q] : d * exact_powers_of_10[q];
+    *out = is_negative ? -d : d;
+    return 1;
+}
+
+// Eisel-Lemire: multiplies the normalized w by a 128-bit truncation of 5^q
+// and takes the 54 significant bits of the product, then rounds to nearest,
+// ties to even. The 128-bit table is always precise enough (Mushtak and
+// Lemire, "Fast Number Parsing Without Fallback", 2023).
+static double eisel_lemire(uint64_t w, int64_t q, int is_negative) {
+    if (w == 0 || q < POWER_OF_FIVE_MIN)
+        return to_double(0, 0, is_negative);
+    if (q > POWER_OF_FIVE_MAX)
+        return to_double(0, INFINITE_POWER, is_negative);
+
+    const int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    const size_t index = 2 * (size_t) (q - POWER_OF_FIVE_MIN);
+    __uint128_t product = (__uint128_t) w * power_of_five_128[index];
+    uint64_t high = (uint64_t) (product >> 64);
+    uint64_t low = (uint64_t) product;
+    // Only if the bits below the 55 we keep are all ones could the next 64
+    // bits of 5^q carry into them
+    const uint64_t precision_mask = 0xFFFFFFFFFFFFFFFFULL >>
+                                    (MANTISSA_EXPLICIT_BITS + 3);
+    if ((high & precision_mask) == precision_mask) {
+        const __uint128_t second = (__uint128_t) w *
+                                   power_of_five_128[index + 1];
+        const uint64_t second_high = (uint64_t) (second >> 64);
+        low += second_high;
+        high += (second_high > low);
+    }
+
+    const int upperbit = (int) (high >> 63);
+    const int shift = upperbit + 64 - MANTISSA_EXPLICIT_BITS - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(log2(10^q)) + 63 = floor(q * log2(10)) + 63
+    int32_t power2 = (int32_t) ((((152170 + 65536) * q) >> 16) + 63) +
+                     upperbit - lz - MINIMUM_EXPONENT;
+
+    if (power2 <= 0) {
+        // Subnormal, or rounds up to the smallest normal
+        if (-power2 + 1 >= 64)
+            return to_double(0, 0, is_negative);
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2 = mantissa < (1ULL << MANTISSA_EXPLICIT_BITS) ? 0 : 1;
+        return to_double(mantissa & ~(1ULL << MANTISSA_EXPLICIT_BITS), power2,
+                         is_negative);
+    }
+
+    // Exactly halfway between two doubles is only possible for small q, where
+    // the product is exact: round to even instead of up
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+        (mantissa << shift) == high)
+        mantissa &= ~1ULL;
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << MANTISSA_EXPLICIT_BITS)) {
+        mantissa = 1ULL << MANTISSA_EXPLICIT_BITS;
+        ++power2;
+    }
+    mantissa &= ~(1ULL << MANTISSA_EXPLICIT_BITS);
+    if (power2 >= INFINITE_POWER)
+        return to_double(0, INFINITE_POWER, is_negative);
+    return to_double(mantissa, power2, is_negative);
+}
+
+const char *char_to_double(const char *first, const char *last, double *out) {
+    const char *p = first;
+    const int is_negative = (p < last && *p == '-');
+    p += is_negative;
+
+    // w = the first 19 significant digits, q = exponent of its last digit
+    uint64_t w = 0;
+    const char *int_start = p;
+    size_t digit_count = parse_digits(&p, last, &w);
+    const char *int_end = p;
+    int64_t q = 0;
+    const char *frac_start = p, *frac_end = p;
+    if (p < last && *p == '.') {
+        frac_start = ++p;
+        digit_count += parse_digits(&p, last, &w);
+        frac_end = p;
+        q = -(int64_t) (frac_end - frac_start);
+    }
+    if (digit_count == 0)
+        return first;
+
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        const int exp_negative = (e < last && *e == '-');
+        e += (e < last && (*e == '-' || *e == '+'));
+        if (e < last && is_digit(*e)) {
+            int64_t exp = 0;
+            for (; e < last && is_digit(*e); ++e) {
+                // Saturate, anything this large is 0 or infinity anyway
+                if (exp < 0x10000000)
+                    exp = exp * 10 + (*e - '0');
+            }
+            q += exp_negative ? -exp : exp;
+            p = e;
+        }
+        // else "1e" or "1e+": the number ends before the 'e'
+    }
+
+    if (digit_count > 19) {
+        // w overflowed. Leading zeros ("0.000123...") don't count, if there
+        // are still more than 19 digits, the correctly rounded result needs
+        // more than w: leave those rare cases to strtod()
+        const char *s = int_start;
+        while (s < frac_end && (*s == '0' || *s == '.'))
+            ++s;
+        const size_t significant = (size_t) (int_end - s > 0 ? int_end - s : 0) +
+                                   (size_t) (frac_end -
+                                             (s > frac_start ? s : frac_start));
+        if (significant > 19) {
+            // strtod() needs a terminated string. It also reads the decimal
+            // point from the locale, see library.h.
+            char buffer[512];
+            const size_t len = (size_t) (p - first);
+            if (len >= sizeof(buffer))
+                return first;
+            memcpy(buffer, first, len);
+            buffer[len] = '\0';
+            *out = strtod(buffer, NULL);
+            return p;
+        }
+    }
+
+    if (!clinger_fast_path(w, q, is_negative, out))
+        *out = eisel_lemire(w, q, is_negative);
+    return p;
+}
@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 // 1 for negative sign, 19 for INT64_MAX and 1 for \0
@@ -16,6 +17,39 @@ void int64_to_char_v2(int64_t in, char *buffer);
 
 void int64_to_char_v3(int64_t in, char *buffer);
 
+// Two digits per division via a "00".."99" table, digit count without
+// branches. Unlike v1..v3, writes the terminating \0 and returns the length
+// (without it).
+size_t int64_to_char_v4(int64_t in, char *buffer);
+
+// v4, but values of 5+ digits are converted 16 digits at a time with SSE2
+// (v4 below 10000, and where SSE2 isn't available). buffer must have BUFFER_SIZE bytes.
+size_t int64_to_char_v5(int64_t in, char *buffer);
+
+// Converts count values with v5, each followed by separator (',' for CSV,
+// '\n' for lines), no \0. out needs count * BUFFER_SIZE bytes. Returns the
+// number of bytes written.
+size_t int64_to_chars_batch(const int64_t *in, size_t count, char separator,
+                            char *out);
+
+// Parse the number at the start of [first, last), which doesn't need to be
+// \0 terminated, like std::from_chars(): returns the end of the number and
+// sets *out, or returns first (and leaves *out alone) if there's no number.
+// No leading whitespace or '+'.
+
+// [-]digits, SWAR: 8 digits per step are checked and combined as one
+// uint64_t. Out of range returns first.
+const char *char_to_int64(const char *first, const char *last, int64_t *out);
+
+// [-]digits[.digits][(e|E)[+|-]digits], no inf/nan/hex, rounded to nearest
+// like strtod(). Eisel-Lemire algorithm (with Clinger's exact fast path in
+// front), which is exact for up to 19 significant digits without fallback.
+// Out of range sets *out to +-inf or +-0, like strtod(), and doesn't fail.
+// More than 19 significant digits go to strtod(), so for those:
+// - the number must be under 512 chars, or it returns first;
+// - the decimal point is the current locale's, '.' only in the "C" locale.
+const char *char_to_double(const char *first, const char *last, double *out);
+
 #ifdef __cplusplus
 }
 #endif
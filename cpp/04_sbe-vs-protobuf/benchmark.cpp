@@ -0,0 +1,673 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <capnp/message.h>
+#include <capnp/serialize.h>
+#include <flatbuffers/flatbuffers.h>
+#include <google/protobuf/arena.h>
+#include <kj/io.h>
+
+#include "capnproto/include/tradeData.capnp.h"
+#include "fb/include/tradeData_generated.h"
+#include "pb/include/tradeData.pb.h"
+#include "sbe/include/Currency.h"
+#include "sbe/include/MessageHeader.h"
+#include "sbe/include/TradeData.h"
+#include "sbe/include/TradeDataBatch.h"
+
+#include "common.hpp"
+#include "symbology.hpp"
+
+// Every codec encodes the same TradeDataStruct samples and decodes them back
+// into a TradeDataStruct, i.e. decoding includes reading every field out,
+// which is where the zero-copy formats (SBE, FlatBuffers, Cap'n Proto) pay.
+//
+// A codec exposes:
+//   span<const char> encode(const TradeDataStruct &);  // valid until the next encode()
+//   void decode(span<const char> bytes, TradeDataStruct &);
+// The bytes handed to decode() are 8-byte aligned, as Cap'n Proto requires.
+
+// Global operator new replacement, so that each benchmark can report its
+// heap allocations per message
+static uint64_t allocationCount = 0;
+
+void *operator new(size_t size) {
+    ++allocationCount;
+    if (void *ptr = malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw bad_alloc();
+}
+// GCC flags free() inlined next to a replaced operator new as a mismatch
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+#pragma GCC diagnostic pop
+
+constexpr size_t sampleCount = std::size(tdsArr);
+
+// Same numbering in every schema. Every schema's enum has only the three
+// currencies, so anything else is sent as the last one, HKD, as before the
+// perfect hash; likewise for codes outside the enum when decoding.
+constexpr uint8_t fallbackCurrency = currencies.size() - 1;
+
+template <size_t N>
+uint8_t currencyCode(const char (&currency)[N]) {
+    const uint8_t code = currencyHash.find(currency);
+    return code == currencyHash.notFound ? fallbackCurrency : code;
+}
+
+void currencyName(const uint8_t code, char (&currency)[4]) {
+    memcpy(currency, currencies[code < currencies.size() ? code : fallbackCurrency], 4);
+}
+
+template <size_t N>
+void copyString(char (&dst)[N], const char *src, const size_t len) {
+    const size_t n = len < N - 1 ? len : N - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+// Baseline: memcpy of a packed struct, no schema, no versioning
+struct RawStructCodec {
+#pragma pack(push, 1)
+    struct Packed {
+        char symbol[6];
+        float price;
+        int32_t quantity;
+        char exchange[7];
+        uint8_t currency;
+    };
+#pragma pack(pop)
+
+    alignas(8) char buffer[BUFSIZE];
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        Packed packed;
+        memcpy(packed.symbol, tds.symbol, sizeof(packed.symbol));
+        packed.price = tds.price;
+        packed.quantity = tds.quantity;
+        memcpy(packed.exchange, tds.exchange, sizeof(packed.exchange));
+        packed.currency = currencyCode(tds.currency);
+        memcpy(buffer, &packed, sizeof(packed));
+        return {buffer, sizeof(packed)};
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        Packed packed;
+        memcpy(&packed, bytes.data(), sizeof(packed));
+        memcpy(tds.symbol, packed.symbol, sizeof(packed.symbol));
+        tds.price = packed.price;
+        tds.quantity = packed.quantity;
+        memcpy(tds.exchange, packed.exchange, sizeof(packed.exchange));
+        currencyName(packed.currency, tds.currency);
+    }
+};
+
+// Field access shared by sbe::TradeData and the sbe::TradeDataBatch::Trades
+// group entry, which have the same fields
+template <class Flyweight>
+void writeSbeTrade(Flyweight &fw, const TradeDataStruct &tds) {
+    fw.quantity(tds.quantity)
+        .putExchange(tds.exchange)
+        .putSymbol(tds.symbol)
+        .price(tds.price)
+        .currency(sbe::Currency::get(currencyCode(tds.currency)));
+}
+
+template <class Flyweight>
+void readSbeTrade(const Flyweight &fw, TradeDataStruct &tds) {
+    fw.getSymbol(tds.symbol, sizeof(tds.symbol));
+    fw.getExchange(tds.exchange, sizeof(tds.exchange));
+    tds.price = fw.price();
+    tds.quantity = fw.quantity();
+    currencyName(fw.currencyRaw(), tds.currency);
+}
+
+struct SbeCodec {
+    static constexpr uint64_t messageHeaderVersion = 0;
+
+    alignas(8) char buffer[BUFSIZE];
+    sbe::MessageHeader hdr;
+    sbe::TradeData td;
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        hdr.wrap(buffer, 0, messageHeaderVersion, sizeof(buffer))
+            .blockLength(sbe::TradeData::sbeBlockLength())
+            .templateId(sbe::TradeData::sbeTemplateId())
+            .schemaId(sbe::TradeData::sbeSchemaId())
+            .version(sbe::TradeData::sbeSchemaVersion());
+        td.wrapForEncode(buffer, hdr.encodedLength(), sizeof(buffer));
+        writeSbeTrade(td, tds);
+        return {buffer, hdr.encodedLength() + td.encodedLength()};
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        // The flyweights take char *, decoding doesn't write through it
+        auto *data = const_cast<char *>(bytes.data());
+        hdr.wrap(data, 0, messageHeaderVersion, bytes.size());
+        td.wrapForDecode(data, hdr.encodedLength(), hdr.blockLength(), hdr.version(), bytes.size());
+        readSbeTrade(td, tds);
+    }
+};
+
+void toProtobuf(const TradeDataStruct &tds, pb::TradeData &td) {
+    td.set_symbol(tds.symbol, packedLength(tds.symbol));
+    td.set_price(tds.price);
+    td.set_quantity(tds.quantity);
+    td.set_exchange(tds.exchange, packedLength(tds.exchange));
+    td.set_currency(static_cast<pb::TradeData::Currency>(currencyCode(tds.currency)));
+}
+
+void fromProtobuf(const pb::TradeData &td, TradeDataStruct &tds) {
+    copyString(tds.symbol, td.symbol().data(), td.symbol().size());
+    tds.price = td.price();
+    tds.quantity = td.quantity();
+    copyString(tds.exchange, td.exchange().data(), td.exchange().size());
+    currencyName(static_cast<uint8_t>(td.currency()), tds.currency);
+}
+
+// ByteSizeLong() caches the size that SerializeWithCachedSizesToArray() needs
+span<const char> serializeToBuffer(const pb::TradeData &td, char (&buffer)[BUFSIZE]) {
+    const size_t size = td.ByteSizeLong();
+    td.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(buffer));
+    return {buffer, size};
+}
+
+// Used the way pb/main.cpp used it: one reused message to encode, a fresh
+// message per decode
+struct ProtobufCodec {
+    pb::TradeData td;
+    string bytes;
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        td.Clear();
+        toProtobuf(tds, td);
+        td.SerializeToString(&bytes);
+        return {bytes.data(), bytes.size()};
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        pb::TradeData msg;
+        msg.ParseFromArray(bytes.data(), static_cast<int>(bytes.size()));
+        fromProtobuf(msg, tds);
+    }
+};
+
+// One message per side, reused for every message. Parsing into a reused
+// message keeps its strings' capacity, so after the first few messages
+// neither side allocates.
+struct ProtobufReuseCodec {
+    pb::TradeData encodeMsg;
+    pb::TradeData decodeMsg;
+    alignas(8) char buffer[BUFSIZE];
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        toProtobuf(tds, encodeMsg);
+        return serializeToBuffer(encodeMsg, buffer);
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        decodeMsg.ParseFromArray(bytes.data(), static_cast<int>(bytes.size()));
+        fromProtobuf(decodeMsg, tds);
+    }
+};
+
+// A fresh message per encode and per decode, as code that hands messages
+// around would have, but allocated on an arena that is reset every
+// arenaBatch messages. The arena's first block is a member buffer, big
+// enough for a batch, so Reset() hands it back instead of freeing it.
+struct ProtobufArenaCodec {
+    static constexpr size_t arenaBatch = 64;
+    static constexpr size_t arenaBlockSize = 64 * 1024;
+
+    unique_ptr<char[]> arenaBlock = make_unique<char[]>(arenaBlockSize);
+    google::protobuf::Arena arena{arenaOptions(arenaBlock.get())};
+    size_t messagesOnArena = 0;
+    alignas(8) char buffer[BUFSIZE];
+
+    static google::protobuf::ArenaOptions arenaOptions(char *block) {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block;
+        options.initial_block_size = arenaBlockSize;
+        return options;
+    }
+
+    pb::TradeData *newMessage() {
+        if (++messagesOnArena > arenaBatch) {
+            arena.Reset();
+            messagesOnArena = 1;
+        }
+        return google::protobuf::Arena::CreateMessage<pb::TradeData>(&arena);
+    }
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        auto *td = newMessage();
+        toProtobuf(tds, *td);
+        return serializeToBuffer(*td, buffer);
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        auto *td = newMessage();
+        td->ParseFromArray(bytes.data(), static_cast<int>(bytes.size()));
+        fromProtobuf(*td, tds);
+    }
+};
+
+// The builder is reused, Clear() keeps its buffer. decode() reads in place,
+// without running the (optional) Verifier.
+struct FlatBuffersCodec {
+    flatbuffers::FlatBufferBuilder builder{BUFSIZE};
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        builder.Clear();
+        const auto exchange = builder.CreateString(tds.exchange, packedLength(tds.exchange));
+        const auto symbol = builder.CreateString(tds.symbol, packedLength(tds.symbol));
+        builder.Finish(fb::CreateTradeData(builder, exchange, symbol, tds.price,
+                                           static_cast<fb::Currency>(currencyCode(tds.currency)), tds.quantity));
+        return {reinterpret_cast<const char *>(builder.GetBufferPointer()), builder.GetSize()};
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        const auto *td = fb::GetTradeData(bytes.data());
+        copyString(tds.symbol, td->symbol()->c_str(), td->symbol()->size());
+        tds.price = td->price();
+        tds.quantity = td->quantity();
+        copyString(tds.exchange, td->exchange()->c_str(), td->exchange()->size());
+        currencyName(static_cast<uint8_t>(td->currency()), tds.currency);
+    }
+};
+
+// The builder's first segment is a reused, zeroed scratch array and the
+// message is written with its segment table (the standard stream framing)
+// into a fixed buffer, so neither side allocates.
+struct CapnProtoCodec {
+    static constexpr size_t scratchWords = 64;
+
+    capnp::word scratch[scratchWords] = {};
+    capnp::word buffer[BUFSIZE / sizeof(capnp::word)];
+
+    span<const char> encode(const TradeDataStruct &tds) {
+        capnp::MallocMessageBuilder message(kj::arrayPtr(scratch, scratchWords));
+        auto td = message.initRoot<cp::TradeData>();
+        td.setExchange(capnp::Text::Reader(tds.exchange, packedLength(tds.exchange)));
+        td.setSymbol(capnp::Text::Reader(tds.symbol, packedLength(tds.symbol)));
+        td.setPrice(tds.price);
+        td.setCurrency(static_cast<cp::TradeData::Currency>(currencyCode(tds.currency)));
+        td.setQuantity(tds.quantity);
+
+        kj::ArrayOutputStream out(kj::arrayPtr(reinterpret_cast<kj::byte *>(buffer), sizeof(buffer)));
+        capnp::writeMessage(out, message);
+        const auto written = out.getArray();
+        return {reinterpret_cast<const char *>(written.begin()), written.size()};
+    }
+
+    void decode(span<const char> bytes, TradeDataStruct &tds) {
+        capnp::FlatArrayMessageReader reader(kj::arrayPtr(reinterpret_cast<const capnp::word *>(bytes.data()),
+                                                          bytes.size() / sizeof(capnp::word)));
+        const auto td = reader.getRoot<cp::TradeData>();
+        const auto symbol = td.getSymbol();
+        copyString(tds.symbol, symbol.cStr(), symbol.size());
+        tds.price = td.getPrice();
+        tds.quantity = td.getQuantity();
+        const auto exchange = td.getExchange();
+        copyString(tds.exchange, exchange.cStr(), exchange.size());
+        currencyName(static_cast<uint8_t>(td.getCurrency()), tds.currency);
+    }
+};
+
+// One encoded sample, aligned for Cap'n Proto
+struct Encoded {
+    alignas(8) char data[BUFSIZE];
+    size_t size = 0;
+
+    span<const char> bytes() const { return {data, size}; }
+};
+
+template <class Codec>
+void encodeSamples(Codec &codec, Encoded *encoded) {
+    for (size_t i = 0; i < sampleCount; ++i) {
+        const auto bytes = codec.encode(tdsArr[i]);
+        memcpy(encoded[i].data, bytes.data(), bytes.size());
+        encoded[i].size = bytes.size();
+    }
+}
+
+// ns/message is the benchmark's own time per iteration, one message each
+void setCounters(benchmark::State &state, const size_t bytes, const uint64_t allocs) {
+    const auto msgs = static_cast<double>(state.iterations());
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes/msg"] = static_cast<double>(bytes) / msgs;
+    state.counters["allocs/msg"] = static_cast<double>(allocs) / msgs;
+}
+
+template <class Codec>
+void BM_Encode(benchmark::State &state) {
+    auto codec = make_unique<Codec>();
+    size_t bytes = 0;
+    size_t i = 0;
+    const uint64_t allocsBefore = allocationCount;
+    for (auto _ : state) {
+        const auto out = codec->encode(tdsArr[i++ % sampleCount]);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+        bytes += out.size();
+    }
+    setCounters(state, bytes, allocationCount - allocsBefore);
+}
+
+template <class Codec>
+void BM_Decode(benchmark::State &state) {
+    auto codec = make_unique<Codec>();
+    auto encoded = make_unique<Encoded[]>(sampleCount);
+    encodeSamples(*codec, encoded.get());
+    TradeDataStruct tds;
+    size_t bytes = 0;
+    size_t i = 0;
+    const uint64_t allocsBefore = allocationCount;
+    for (auto _ : state) {
+        const auto &in = encoded[i++ % sampleCount];
+        codec->decode(in.bytes(), tds);
+        benchmark::DoNotOptimize(tds);
+        bytes += in.size;
+    }
+    setCounters(state, bytes, allocationCount - allocsBefore);
+}
+
+template <class Codec>
+void BM_RoundTrip(benchmark::State &state) {
+    auto codec = make_unique<Codec>();
+    auto staging = make_unique<Encoded>();
+    TradeDataStruct tds;
+    size_t bytes = 0;
+    size_t i = 0;
+    const uint64_t allocsBefore = allocationCount;
+    for (auto _ : state) {
+        const auto out = codec->encode(tdsArr[i++ % sampleCount]);
+        // What a transport would do between the two sides, also gives
+        // decode() the alignment it needs
+        memcpy(staging->data, out.data(), out.size());
+        staging->size = out.size();
+        codec->decode(staging->bytes(), tds);
+        benchmark::DoNotOptimize(tds);
+        bytes += out.size();
+    }
+    setCounters(state, bytes, allocationCount - allocsBefore);
+}
+
+#define CODEC_BENCHMARKS(CODEC)                                                \
+    BENCHMARK_TEMPLATE(BM_Encode, CODEC);                                      \
+    BENCHMARK_TEMPLATE(BM_Decode, CODEC);                                      \
+    BENCHMARK_TEMPLATE(BM_RoundTrip, CODEC)
+
+CODEC_BENCHMARKS(RawStructCodec);
+CODEC_BENCHMARKS(SbeCodec);
+CODEC_BENCHMARKS(ProtobufCodec);
+CODEC_BENCHMARKS(ProtobufReuseCodec);
+CODEC_BENCHMARKS(ProtobufArenaCodec);
+CODEC_BENCHMARKS(FlatBuffersCodec);
+CODEC_BENCHMARKS(CapnProtoCodec);
+
+// String handling on its own, the part of every encode/decode above that
+// isn't the codec: turning the currency, exchange and symbol strings into
+// codes and measuring strings before copying them. StrcmpStrings is how
+// it's usually written, PackedStrings uses symbology.hpp.
+struct StrcmpStrings {
+    template <size_t N>
+    static uint8_t lookup(const char *s, const array<const char *, N> &names) {
+        for (size_t i = 0; i < N; ++i) {
+            if (strcmp(s, names[i]) == 0)
+                return static_cast<uint8_t>(i);
+        }
+        return 0xff;
+    }
+
+    static uint8_t currency(const TradeDataStruct &tds) { return lookup(tds.currency, currencies); }
+    static uint8_t exchange(const TradeDataStruct &tds) { return lookup(tds.exchange, exchanges); }
+    static uint8_t symbol(const TradeDataStruct &tds) { return lookup(tds.symbol, symbols); }
+    static size_t lengths(const TradeDataStruct &tds) { return strlen(tds.symbol) + strlen(tds.exchange); }
+};
+
+struct PackedStrings {
+    static uint8_t currency(const TradeDataStruct &tds) { return currencyHash.find(tds.currency); }
+    static uint8_t exchange(const TradeDataStruct &tds) { return exchangeHash.find(tds.exchange); }
+    static uint8_t symbol(const TradeDataStruct &tds) { return symbolHash.find(tds.symbol); }
+    static size_t lengths(const TradeDataStruct &tds) { return packedLength(tds.symbol) + packedLength(tds.exchange); }
+};
+
+template <class Strings>
+void BM_StringHandling(benchmark::State &state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const TradeDataStruct *tds = &tdsArr[i++ % sampleCount];
+        // Hide which sample it is, or the lookups get constant folded
+        benchmark::DoNotOptimize(tds);
+        switch (state.range(0)) {
+        case 0:
+            benchmark::DoNotOptimize(Strings::currency(*tds));
+            break;
+        case 1:
+            benchmark::DoNotOptimize(Strings::exchange(*tds));
+            break;
+        case 2:
+            benchmark::DoNotOptimize(Strings::symbol(*tds));
+            break;
+        default:
+            benchmark::DoNotOptimize(Strings::lengths(*tds));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 0: currency code, 1: exchange code, 2: symbol code, 3: symbol + exchange length
+BENCHMARK_TEMPLATE(BM_StringHandling, StrcmpStrings)->ArgName("field")->DenseRange(0, 3);
+BENCHMARK_TEMPLATE(BM_StringHandling, PackedStrings)->ArgName("field")->DenseRange(0, 3);
+
+// Packets of trades, as a feed sends them: a UDP datagram that fits a 1500
+// byte Ethernet MTU (1472 bytes) or a 64 KB buffer, filled with as many
+// trades as fit. Two ways to lay a packet out with SBE:
+//   per-message: MessageHeader + TradeData, repeated
+//   batch: one MessageHeader + TradeDataBatch, whose trades repeating group
+//          carries all of them (4 byte group header + 22 bytes per trade)
+// The batch decoder walks the group in place, the packet is never copied.
+// items_per_second is trades/s.
+constexpr uint64_t sbeMessageHeaderVersion = 0;
+
+struct SbeMessagePacket {
+    static size_t tradesPerPacket(const size_t packetSize) {
+        return packetSize / (sbe::MessageHeader::encodedLength() + sbe::TradeData::sbeBlockLength());
+    }
+
+    // Returns the packet's length, trades are taken round-robin from tdsArr
+    // starting at `next`, which is advanced
+    static size_t encode(char *packet, const size_t packetSize, size_t &next) {
+        sbe::MessageHeader hdr;
+        sbe::TradeData td;
+        const size_t n = tradesPerPacket(packetSize);
+        uint64_t offset = 0;
+        for (size_t i = 0; i < n; ++i) {
+            hdr.wrap(packet, offset, sbeMessageHeaderVersion, packetSize)
+                .blockLength(sbe::TradeData::sbeBlockLength())
+                .templateId(sbe::TradeData::sbeTemplateId())
+                .schemaId(sbe::TradeData::sbeSchemaId())
+                .version(sbe::TradeData::sbeSchemaVersion());
+            td.wrapForEncode(packet, offset + hdr.encodedLength(), packetSize);
+            writeSbeTrade(td, tdsArr[next++ % sampleCount]);
+            offset += hdr.encodedLength() + td.encodedLength();
+        }
+        return offset;
+    }
+
+    // Calls onTrade(flyweight) for every trade in the packet, returns how many
+    template <class OnTrade>
+    static size_t decode(char *packet, const size_t length, OnTrade &&onTrade) {
+        sbe::MessageHeader hdr;
+        sbe::TradeData td;
+        size_t n = 0;
+        for (uint64_t offset = 0; offset < length; offset += hdr.encodedLength() + td.encodedLength(), ++n) {
+            hdr.wrap(packet, offset, sbeMessageHeaderVersion, length);
+            td.wrapForDecode(packet, offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(), length);
+            onTrade(td);
+        }
+        return n;
+    }
+};
+
+struct SbeBatchPacket {
+    static size_t tradesPerPacket(const size_t packetSize) {
+        const size_t fixed = sbe::MessageHeader::encodedLength() + sbe::TradeDataBatch::computeLength(0);
+        return min<size_t>((packetSize - fixed) / sbe::TradeDataBatch::Trades::sbeBlockLength(), 65534);
+    }
+
+    static size_t encode(char *packet, const size_t packetSize, size_t &next) {
+        sbe::TradeDataBatch batch;
+        batch.wrapAndApplyHeader(packet, 0, packetSize);
+        const size_t n = tradesPerPacket(packetSize);
+        auto &trades = batch.tradesCount(static_cast<uint16_t>(n));
+        for (size_t i = 0; i < n; ++i)
+            writeSbeTrade(trades.next(), tdsArr[next++ % sampleCount]);
+        return sbe::MessageHeader::encodedLength() + batch.encodedLength();
+    }
+
+    template <class OnTrade>
+    static size_t decode(char *packet, const size_t length, OnTrade &&onTrade) {
+        sbe::MessageHeader hdr(packet, 0, length, sbeMessageHeaderVersion);
+        sbe::TradeDataBatch batch;
+        batch.wrapForDecode(packet, hdr.encodedLength(), hdr.blockLength(), hdr.version(), length);
+        auto &trades = batch.trades();
+        const size_t n = trades.count();
+        while (trades.hasNext())
+            onTrade(trades.next());
+        return n;
+    }
+};
+
+void setPacketCounters(benchmark::State &state, const size_t trades, const size_t bytes) {
+    state.SetItemsProcessed(static_cast<int64_t>(trades));
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.counters["trades/packet"] = static_cast<double>(trades) / static_cast<double>(state.iterations());
+}
+
+template <class Packet>
+void BM_SbePacketEncode(benchmark::State &state) {
+    const auto packetSize = static_cast<size_t>(state.range(0));
+    auto packet = make_unique<char[]>(packetSize);
+    size_t next = 0;
+    size_t trades = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        const size_t before = next;
+        bytes += Packet::encode(packet.get(), packetSize, next);
+        benchmark::DoNotOptimize(packet.get());
+        benchmark::ClobberMemory();
+        trades += next - before;
+    }
+    setPacketCounters(state, trades, bytes);
+}
+
+template <class Packet>
+void BM_SbePacketDecode(benchmark::State &state) {
+    const auto packetSize = static_cast<size_t>(state.range(0));
+    auto packet = make_unique<char[]>(packetSize);
+    size_t next = 0;
+    const size_t length = Packet::encode(packet.get(), packetSize, next);
+    TradeDataStruct tds;
+    size_t trades = 0;
+    for (auto _ : state) {
+        trades += Packet::decode(packet.get(), length, [&](const auto &fw) {
+            readSbeTrade(fw, tds);
+            benchmark::DoNotOptimize(tds);
+        });
+    }
+    setPacketCounters(state, trades, length * static_cast<size_t>(state.iterations()));
+}
+
+BENCHMARK_TEMPLATE(BM_SbePacketEncode, SbeMessagePacket)->Arg(1472)->Arg(64 * 1024);
+BENCHMARK_TEMPLATE(BM_SbePacketEncode, SbeBatchPacket)->Arg(1472)->Arg(64 * 1024);
+BENCHMARK_TEMPLATE(BM_SbePacketDecode, SbeMessagePacket)->Arg(1472)->Arg(64 * 1024);
+BENCHMARK_TEMPLATE(BM_SbePacketDecode, SbeBatchPacket)->Arg(1472)->Arg(64 * 1024);
+
+bool sameTradeData(const TradeDataStruct &a, const TradeDataStruct &b) {
+    return strcmp(a.symbol, b.symbol) == 0 && a.price == b.price && a.quantity == b.quantity &&
+           strcmp(a.exchange, b.exchange) == 0 && strcmp(a.currency, b.currency) == 0;
+}
+
+// Every codec must give back what it was given before its numbers mean anything
+template <class Codec>
+bool verifyRoundTrip(const char *name) {
+    auto codec = make_unique<Codec>();
+    auto encoded = make_unique<Encoded>();
+    for (const auto &sample : tdsArr) {
+        const auto out = codec->encode(sample);
+        memcpy(encoded->data, out.data(), out.size());
+        encoded->size = out.size();
+        TradeDataStruct decoded;
+        codec->decode(encoded->bytes(), decoded);
+        if (!sameTradeData(sample, decoded)) {
+            cerr << name << " round trip mismatch" << endl;
+            printTradeDataStruct(decoded);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class Packet>
+bool verifyPacket(const char *name) {
+    alignas(8) char packet[1472];
+    size_t next = 0;
+    const size_t length = Packet::encode(packet, sizeof(packet), next);
+    size_t i = 0;
+    bool same = true;
+    const size_t n = Packet::decode(packet, length, [&](const auto &fw) {
+        TradeDataStruct decoded;
+        readSbeTrade(fw, decoded);
+        same = same && sameTradeData(tdsArr[i++ % sampleCount], decoded);
+    });
+    if (!same || n != next) {
+        cerr << name << " packet mismatch" << endl;
+        return false;
+    }
+    return true;
+}
+
+// The packed lookups must agree with strcmp()/strlen() on every sample
+bool verifyStrings() {
+    for (const auto &tds : tdsArr) {
+        if (StrcmpStrings::currency(tds) != PackedStrings::currency(tds) ||
+            StrcmpStrings::exchange(tds) != PackedStrings::exchange(tds) ||
+            StrcmpStrings::symbol(tds) != PackedStrings::symbol(tds) ||
+            StrcmpStrings::lengths(tds) != PackedStrings::lengths(tds)) {
+            cerr << "packed string handling mismatch" << endl;
+            printTradeDataStruct(tds);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!verifyStrings() || !verifyRoundTrip<RawStructCodec>("raw") || !verifyRoundTrip<SbeCodec>("SBE") ||
+        !verifyRoundTrip<ProtobufCodec>("protobuf") || !verifyRoundTrip<ProtobufReuseCodec>("protobuf reuse") ||
+        !verifyRoundTrip<ProtobufArenaCodec>("protobuf arena") || !verifyRoundTrip<FlatBuffersCodec>("FlatBuffers") ||
+        !verifyRoundTrip<CapnProtoCodec>("Cap'n Proto") || !verifyPacket<SbeMessagePacket>("SBE per-message") ||
+        !verifyPacket<SbeBatchPacket>("SBE batch")) {
+        return 1;
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -5,7 +5,6 @@
 using namespace std;
 
 #define BUFSIZE 4096
-#define ITER_COUNT 10000000UL
 
 struct TradeDataStruct {
     char symbol[6] = {0};
@@ -31,11 +30,3 @@ void printTradeDataStruct(const TradeDataStruct& tds) {
          << "Exchange: " << tds.exchange << "\n"
          << endl;
 }
-
-void printElaspsedTime(const clock_t diff) {
-    cout << "Iterated " << ITER_COUNT / 1000 / 1000 << " mil times\n"
-         << "Elapsed "<< diff / 1000.0 << "ms (" << ITER_COUNT * 1.0 / diff
-         << " mil records per sec or "
-         << setprecision(2) << 1000 * diff / ITER_COUNT
-         << " ns per record)" << endl;
-}
\ No newline at end of file
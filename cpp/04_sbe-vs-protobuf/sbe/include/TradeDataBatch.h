@@ -0,0 +1,1225 @@
+/* Generated SBE (Simple Binary Encoding) message codec */
+#ifndef _SBE_TRADEDATABATCH_H_
+#define _SBE_TRADEDATABATCH_H_
+
+#if defined(SBE_HAVE_CMATH)
+/* cmath needed for std::numeric_limits<double>::quiet_NaN() */
+#  include <cmath>
+#  define SBE_FLOAT_NAN std::numeric_limits<float>::quiet_NaN()
+#  define SBE_DOUBLE_NAN std::numeric_limits<double>::quiet_NaN()
+#else
+/* math.h needed for NAN */
+#  include <math.h>
+#  define SBE_FLOAT_NAN NAN
+#  define SBE_DOUBLE_NAN NAN
+#endif
+
+#if __cplusplus >= 201103L
+#  define SBE_CONSTEXPR constexpr
+#  define SBE_NOEXCEPT noexcept
+#else
+#  define SBE_CONSTEXPR
+#  define SBE_NOEXCEPT
+#endif
+
+#if __cplusplus >= 201703L
+#  include <string_view>
+#  define SBE_NODISCARD [[nodiscard]]
+#else
+#  define SBE_NODISCARD
+#endif
+
+#if !defined(__STDC_LIMIT_MACROS)
+#  define __STDC_LIMIT_MACROS 1
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tuple>
+
+#if defined(WIN32) || defined(_WIN32)
+#  define SBE_BIG_ENDIAN_ENCODE_16(v) _byteswap_ushort(v)
+#  define SBE_BIG_ENDIAN_ENCODE_32(v) _byteswap_ulong(v)
+#  define SBE_BIG_ENDIAN_ENCODE_64(v) _byteswap_uint64(v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_16(v) (v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_32(v) (v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_64(v) (v)
+#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#  define SBE_BIG_ENDIAN_ENCODE_16(v) __builtin_bswap16(v)
+#  define SBE_BIG_ENDIAN_ENCODE_32(v) __builtin_bswap32(v)
+#  define SBE_BIG_ENDIAN_ENCODE_64(v) __builtin_bswap64(v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_16(v) (v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_32(v) (v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_64(v) (v)
+#elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#  define SBE_LITTLE_ENDIAN_ENCODE_16(v) __builtin_bswap16(v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_32(v) __builtin_bswap32(v)
+#  define SBE_LITTLE_ENDIAN_ENCODE_64(v) __builtin_bswap64(v)
+#  define SBE_BIG_ENDIAN_ENCODE_16(v) (v)
+#  define SBE_BIG_ENDIAN_ENCODE_32(v) (v)
+#  define SBE_BIG_ENDIAN_ENCODE_64(v) (v)
+#else
+#  error "Byte Ordering of platform not determined. Set __BYTE_ORDER__ manually before including this file."
+#endif
+
+#if defined(SBE_NO_BOUNDS_CHECK)
+#  define SBE_BOUNDS_CHECK_EXPECT(exp, c) (false)
+#elif defined(_MSC_VER)
+#  define SBE_BOUNDS_CHECK_EXPECT(exp, c) (exp)
+#else
+#  define SBE_BOUNDS_CHECK_EXPECT(exp, c) (__builtin_expect(exp, c))
+#endif
+
+#define SBE_NULLVALUE_INT8 (std::numeric_limits<std::int8_t>::min)()
+#define SBE_NULLVALUE_INT16 (std::numeric_limits<std::int16_t>::min)()
+#define SBE_NULLVALUE_INT32 (std::numeric_limits<std::int32_t>::min)()
+#define SBE_NULLVALUE_INT64 (std::numeric_limits<std::int64_t>::min)()
+#define SBE_NULLVALUE_UINT8 (std::numeric_limits<std::uint8_t>::max)()
+#define SBE_NULLVALUE_UINT16 (std::numeric_limits<std::uint16_t>::max)()
+#define SBE_NULLVALUE_UINT32 (std::numeric_limits<std::uint32_t>::max)()
+#define SBE_NULLVALUE_UINT64 (std::numeric_limits<std::uint64_t>::max)()
+
+
+#include "MessageHeader.h"
+#include "GroupSizeEncoding.h"
+#include "Currency.h"
+
+namespace sbe {
+
+class TradeDataBatch
+{
+private:
+    char *m_buffer = nullptr;
+    std::uint64_t m_bufferLength = 0;
+    std::uint64_t m_offset = 0;
+    std::uint64_t m_position = 0;
+    std::uint64_t m_actingBlockLength = 0;
+    std::uint64_t m_actingVersion = 0;
+
+    inline std::uint64_t *sbePositionPtr() SBE_NOEXCEPT
+    {
+        return &m_position;
+    }
+
+public:
+    static const std::uint16_t SBE_BLOCK_LENGTH = static_cast<std::uint16_t>(0);
+    static const std::uint16_t SBE_TEMPLATE_ID = static_cast<std::uint16_t>(2);
+    static const std::uint16_t SBE_SCHEMA_ID = static_cast<std::uint16_t>(1);
+    static const std::uint16_t SBE_SCHEMA_VERSION = static_cast<std::uint16_t>(0);
+
+    enum MetaAttribute
+    {
+        EPOCH, TIME_UNIT, SEMANTIC_TYPE, PRESENCE
+    };
+
+    union sbe_float_as_uint_u
+    {
+        float fp_value;
+        std::uint32_t uint_value;
+    };
+
+    union sbe_double_as_uint_u
+    {
+        double fp_value;
+        std::uint64_t uint_value;
+    };
+
+    using messageHeader = MessageHeader;
+
+    TradeDataBatch() = default;
+
+    TradeDataBatch(
+        char *buffer,
+        const std::uint64_t offset,
+        const std::uint64_t bufferLength,
+        const std::uint64_t actingBlockLength,
+        const std::uint64_t actingVersion) :
+        m_buffer(buffer),
+        m_bufferLength(bufferLength),
+        m_offset(offset),
+        m_position(sbeCheckPosition(offset + actingBlockLength)),
+        m_actingBlockLength(actingBlockLength),
+        m_actingVersion(actingVersion)
+    {
+    }
+
+    TradeDataBatch(char *buffer, const std::uint64_t bufferLength) :
+        TradeDataBatch(buffer, 0, bufferLength, sbeBlockLength(), sbeSchemaVersion())
+    {
+    }
+
+    TradeDataBatch(
+        char *buffer,
+        const std::uint64_t bufferLength,
+        const std::uint64_t actingBlockLength,
+        const std::uint64_t actingVersion) :
+        TradeDataBatch(buffer, 0, bufferLength, actingBlockLength, actingVersion)
+    {
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint16_t sbeBlockLength() SBE_NOEXCEPT
+    {
+        return static_cast<std::uint16_t>(0);
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t sbeBlockAndHeaderLength() SBE_NOEXCEPT
+    {
+        return messageHeader::encodedLength() + sbeBlockLength();
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint16_t sbeTemplateId() SBE_NOEXCEPT
+    {
+        return static_cast<std::uint16_t>(2);
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint16_t sbeSchemaId() SBE_NOEXCEPT
+    {
+        return static_cast<std::uint16_t>(1);
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint16_t sbeSchemaVersion() SBE_NOEXCEPT
+    {
+        return static_cast<std::uint16_t>(0);
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR const char *sbeSemanticType() SBE_NOEXCEPT
+    {
+        return "";
+    }
+
+    SBE_NODISCARD std::uint64_t offset() const SBE_NOEXCEPT
+    {
+        return m_offset;
+    }
+
+    TradeDataBatch &wrapForEncode(char *buffer, const std::uint64_t offset, const std::uint64_t bufferLength)
+    {
+        return *this = TradeDataBatch(buffer, offset, bufferLength, sbeBlockLength(), sbeSchemaVersion());
+    }
+
+    TradeDataBatch &wrapAndApplyHeader(char *buffer, const std::uint64_t offset, const std::uint64_t bufferLength)
+    {
+        messageHeader hdr(buffer, offset, bufferLength, sbeSchemaVersion());
+
+        hdr
+            .blockLength(sbeBlockLength())
+            .templateId(sbeTemplateId())
+            .schemaId(sbeSchemaId())
+            .version(sbeSchemaVersion());
+
+        return *this = TradeDataBatch(
+            buffer,
+            offset + messageHeader::encodedLength(),
+            bufferLength,
+            sbeBlockLength(),
+            sbeSchemaVersion());
+    }
+
+    TradeDataBatch &wrapForDecode(
+        char *buffer,
+        const std::uint64_t offset,
+        const std::uint64_t actingBlockLength,
+        const std::uint64_t actingVersion,
+        const std::uint64_t bufferLength)
+    {
+        return *this = TradeDataBatch(buffer, offset, bufferLength, actingBlockLength, actingVersion);
+    }
+
+    TradeDataBatch &sbeRewind()
+    {
+        return wrapForDecode(m_buffer, m_offset, m_actingBlockLength, m_actingVersion, m_bufferLength);
+    }
+
+    SBE_NODISCARD std::uint64_t sbePosition() const SBE_NOEXCEPT
+    {
+        return m_position;
+    }
+
+    // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+    std::uint64_t sbeCheckPosition(const std::uint64_t position)
+    {
+        if (SBE_BOUNDS_CHECK_EXPECT((position > m_bufferLength), false))
+        {
+            throw std::runtime_error("buffer too short [E100]");
+        }
+        return position;
+    }
+
+    void sbePosition(const std::uint64_t position)
+    {
+        m_position = sbeCheckPosition(position);
+    }
+
+    SBE_NODISCARD std::uint64_t encodedLength() const SBE_NOEXCEPT
+    {
+        return sbePosition() - m_offset;
+    }
+
+    SBE_NODISCARD std::uint64_t decodeLength() const
+    {
+        TradeDataBatch skipper(m_buffer, m_offset, m_bufferLength, sbeBlockLength(), m_actingVersion);
+        skipper.skip();
+        return skipper.encodedLength();
+    }
+
+    SBE_NODISCARD const char *buffer() const SBE_NOEXCEPT
+    {
+        return m_buffer;
+    }
+
+    SBE_NODISCARD char *buffer() SBE_NOEXCEPT
+    {
+        return m_buffer;
+    }
+
+    SBE_NODISCARD std::uint64_t bufferLength() const SBE_NOEXCEPT
+    {
+        return m_bufferLength;
+    }
+
+    SBE_NODISCARD std::uint64_t actingVersion() const SBE_NOEXCEPT
+    {
+        return m_actingVersion;
+    }
+
+    class Trades
+    {
+    private:
+        char *m_buffer = nullptr;
+        std::uint64_t m_bufferLength = 0;
+        std::uint64_t m_initialPosition = 0;
+        std::uint64_t *m_positionPtr = nullptr;
+        std::uint64_t m_blockLength = 0;
+        std::uint64_t m_count = 0;
+        std::uint64_t m_index = 0;
+        std::uint64_t m_offset = 0;
+        std::uint64_t m_actingVersion = 0;
+
+        SBE_NODISCARD std::uint64_t *sbePositionPtr() SBE_NOEXCEPT
+        {
+            return m_positionPtr;
+        }
+
+    public:
+        Trades() = default;
+
+        inline void wrapForDecode(
+            char *buffer,
+            std::uint64_t *pos,
+            const std::uint64_t actingVersion,
+            const std::uint64_t bufferLength)
+        {
+            GroupSizeEncoding dimensions(buffer, *pos, bufferLength, actingVersion);
+            m_buffer = buffer;
+            m_bufferLength = bufferLength;
+            m_blockLength = dimensions.blockLength();
+            m_count = dimensions.numInGroup();
+            m_index = 0;
+            m_actingVersion = actingVersion;
+            m_initialPosition = *pos;
+            m_positionPtr = pos;
+            *m_positionPtr = *m_positionPtr + 4;
+        }
+
+        inline void wrapForEncode(
+            char *buffer,
+            const std::uint16_t count,
+            std::uint64_t *pos,
+            const std::uint64_t actingVersion,
+            const std::uint64_t bufferLength)
+        {
+    #if defined(__GNUG__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wtype-limits"
+    #endif
+            if (count > 65534)
+            {
+                throw std::runtime_error("count outside of allowed range [E110]");
+            }
+    #if defined(__GNUG__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+    #endif
+            m_buffer = buffer;
+            m_bufferLength = bufferLength;
+            GroupSizeEncoding dimensions(buffer, *pos, bufferLength, actingVersion);
+            dimensions.blockLength(static_cast<std::uint16_t>(22));
+            dimensions.numInGroup(static_cast<std::uint16_t>(count));
+            m_index = 0;
+            m_count = count;
+            m_blockLength = 22;
+            m_actingVersion = actingVersion;
+            m_initialPosition = *pos;
+            m_positionPtr = pos;
+            *m_positionPtr = *m_positionPtr + 4;
+        }
+
+        static SBE_CONSTEXPR std::uint64_t sbeHeaderSize() SBE_NOEXCEPT
+        {
+            return 4;
+        }
+
+        static SBE_CONSTEXPR std::uint64_t sbeBlockLength() SBE_NOEXCEPT
+        {
+            return 22;
+        }
+
+        SBE_NODISCARD std::uint64_t sbeActingBlockLength() SBE_NOEXCEPT
+        {
+            return m_blockLength;
+        }
+
+        SBE_NODISCARD std::uint64_t sbePosition() const SBE_NOEXCEPT
+        {
+            return *m_positionPtr;
+        }
+
+        // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+        std::uint64_t sbeCheckPosition(const std::uint64_t position)
+        {
+            if (SBE_BOUNDS_CHECK_EXPECT((position > m_bufferLength), false))
+            {
+                throw std::runtime_error("buffer too short [E100]");
+            }
+            return position;
+        }
+
+        void sbePosition(const std::uint64_t position)
+        {
+            *m_positionPtr = sbeCheckPosition(position);
+        }
+
+        SBE_NODISCARD inline std::uint64_t count() const SBE_NOEXCEPT
+        {
+            return m_count;
+        }
+
+        SBE_NODISCARD inline bool hasNext() const SBE_NOEXCEPT
+        {
+            return m_index < m_count;
+        }
+
+        inline Trades &next()
+        {
+            if (m_index >= m_count)
+            {
+                throw std::runtime_error("index >= count [E108]");
+            }
+            m_offset = *m_positionPtr;
+            if (SBE_BOUNDS_CHECK_EXPECT(((m_offset + m_blockLength) > m_bufferLength), false))
+            {
+                throw std::runtime_error("buffer too short for next group index [E108]");
+            }
+            *m_positionPtr = m_offset + m_blockLength;
+            ++m_index;
+
+            return *this;
+        }
+
+        inline std::uint64_t resetCountToIndex()
+        {
+            m_count = m_index;
+            GroupSizeEncoding dimensions(m_buffer, m_initialPosition, m_bufferLength, m_actingVersion);
+            dimensions.numInGroup(static_cast<std::uint16_t>(m_count));
+            return m_count;
+        }
+
+        template<class Func> inline void forEach(Func &&func)
+        {
+            while (hasNext())
+            {
+                next();
+                func(*this);
+            }
+        }
+
+        SBE_NODISCARD static const char *exchangeMetaAttribute(const MetaAttribute metaAttribute) SBE_NOEXCEPT
+        {
+            switch (metaAttribute)
+            {
+                case MetaAttribute::PRESENCE: return "required";
+                default: return "";
+            }
+        }
+
+        static SBE_CONSTEXPR std::uint16_t exchangeId() SBE_NOEXCEPT
+        {
+            return 1;
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t exchangeSinceVersion() SBE_NOEXCEPT
+        {
+            return 0;
+        }
+
+        SBE_NODISCARD bool exchangeInActingVersion() SBE_NOEXCEPT
+        {
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#endif
+            return m_actingVersion >= exchangeSinceVersion();
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::size_t exchangeEncodingOffset() SBE_NOEXCEPT
+        {
+            return 0;
+        }
+
+        static SBE_CONSTEXPR char exchangeNullValue() SBE_NOEXCEPT
+        {
+            return static_cast<char>(0);
+        }
+
+        static SBE_CONSTEXPR char exchangeMinValue() SBE_NOEXCEPT
+        {
+            return static_cast<char>(32);
+        }
+
+        static SBE_CONSTEXPR char exchangeMaxValue() SBE_NOEXCEPT
+        {
+            return static_cast<char>(126);
+        }
+
+        static SBE_CONSTEXPR std::size_t exchangeEncodingLength() SBE_NOEXCEPT
+        {
+            return 7;
+        }
+
+        static SBE_CONSTEXPR std::uint64_t exchangeLength() SBE_NOEXCEPT
+        {
+            return 7;
+        }
+
+        SBE_NODISCARD const char *exchange() const SBE_NOEXCEPT
+        {
+            return m_buffer + m_offset + 0;
+        }
+
+        SBE_NODISCARD char *exchange() SBE_NOEXCEPT
+        {
+            return m_buffer + m_offset + 0;
+        }
+
+        SBE_NODISCARD char exchange(const std::uint64_t index) const
+        {
+            if (index >= 7)
+            {
+                throw std::runtime_error("index out of range for exchange [E104]");
+            }
+
+            char val;
+            std::memcpy(&val, m_buffer + m_offset + 0 + (index * 1), sizeof(char));
+            return (val);
+        }
+
+        Trades &exchange(const std::uint64_t index, const char value)
+        {
+            if (index >= 7)
+            {
+                throw std::runtime_error("index out of range for exchange [E105]");
+            }
+
+            char val = (value);
+            std::memcpy(m_buffer + m_offset + 0 + (index * 1), &val, sizeof(char));
+            return *this;
+        }
+
+        std::uint64_t getExchange(char *const dst, const std::uint64_t length) const
+        {
+            if (length > 7)
+            {
+                throw std::runtime_error("length too large for getExchange [E106]");
+            }
+
+            std::memcpy(dst, m_buffer + m_offset + 0, sizeof(char) * static_cast<std::size_t>(length));
+            return length;
+        }
+
+        Trades &putExchange(const char *const src) SBE_NOEXCEPT
+        {
+            std::memcpy(m_buffer + m_offset + 0, src, sizeof(char) * 7);
+            return *this;
+        }
+
+        SBE_NODISCARD std::string getExchangeAsString() const
+        {
+            const char *buffer = m_buffer + m_offset + 0;
+            std::size_t length = 0;
+
+            for (; length < 7 && *(buffer + length) != '\0'; ++length);
+            std::string result(buffer, length);
+
+            return result;
+        }
+
+        std::string getExchangeAsJsonEscapedString()
+        {
+            std::ostringstream oss;
+            std::string s = getExchangeAsString();
+
+            for (const auto c : s)
+            {
+                switch (c)
+                {
+                    case '"': oss << "\\\""; break;
+                    case '\\': oss << "\\\\"; break;
+                    case '\b': oss << "\\b"; break;
+                    case '\f': oss << "\\f"; break;
+                    case '\n': oss << "\\n"; break;
+                    case '\r': oss << "\\r"; break;
+                    case '\t': oss << "\\t"; break;
+
+                    default:
+                        if ('\x00' <= c && c <= '\x1f')
+                        {
+                            oss << "\\u" << std::hex << std::setw(4)
+                                << std::setfill('0') << (int)(c);
+                        }
+                        else
+                        {
+                            oss << c;
+                        }
+                }
+            }
+
+            return oss.str();
+        }
+
+        #if __cplusplus >= 201703L
+        SBE_NODISCARD std::string_view getExchangeAsStringView() const SBE_NOEXCEPT
+        {
+            const char *buffer = m_buffer + m_offset + 0;
+            std::size_t length = 0;
+
+            for (; length < 7 && *(buffer + length) != '\0'; ++length);
+            std::string_view result(buffer, length);
+
+            return result;
+        }
+        #endif
+
+        #if __cplusplus >= 201703L
+        Trades &putExchange(const std::string_view str)
+        {
+            const std::size_t srcLength = str.length();
+            if (srcLength > 7)
+            {
+                throw std::runtime_error("string too large for putExchange [E106]");
+            }
+
+            std::memcpy(m_buffer + m_offset + 0, str.data(), srcLength);
+            for (std::size_t start = srcLength; start < 7; ++start)
+            {
+                m_buffer[m_offset + 0 + start] = 0;
+            }
+
+            return *this;
+        }
+        #else
+        Trades &putExchange(const std::string &str)
+        {
+            const std::size_t srcLength = str.length();
+            if (srcLength > 7)
+            {
+                throw std::runtime_error("string too large for putExchange [E106]");
+            }
+
+            std::memcpy(m_buffer + m_offset + 0, str.c_str(), srcLength);
+            for (std::size_t start = srcLength; start < 7; ++start)
+            {
+                m_buffer[m_offset + 0 + start] = 0;
+            }
+
+            return *this;
+        }
+        #endif
+
+        SBE_NODISCARD static const char *symbolMetaAttribute(const MetaAttribute metaAttribute) SBE_NOEXCEPT
+        {
+            switch (metaAttribute)
+            {
+                case MetaAttribute::PRESENCE: return "required";
+                default: return "";
+            }
+        }
+
+        static SBE_CONSTEXPR std::uint16_t symbolId() SBE_NOEXCEPT
+        {
+            return 2;
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t symbolSinceVersion() SBE_NOEXCEPT
+        {
+            return 0;
+        }
+
+        SBE_NODISCARD bool symbolInActingVersion() SBE_NOEXCEPT
+        {
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#endif
+            return m_actingVersion >= symbolSinceVersion();
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::size_t symbolEncodingOffset() SBE_NOEXCEPT
+        {
+            return 7;
+        }
+
+        static SBE_CONSTEXPR char symbolNullValue() SBE_NOEXCEPT
+        {
+            return static_cast<char>(0);
+        }
+
+        static SBE_CONSTEXPR char symbolMinValue() SBE_NOEXCEPT
+        {
+            return static_cast<char>(32);
+        }
+
+        static SBE_CONSTEXPR char symbolMaxValue() SBE_NOEXCEPT
+        {
+            return static_cast<char>(126);
+        }
+
+        static SBE_CONSTEXPR std::size_t symbolEncodingLength() SBE_NOEXCEPT
+        {
+            return 6;
+        }
+
+        static SBE_CONSTEXPR std::uint64_t symbolLength() SBE_NOEXCEPT
+        {
+            return 6;
+        }
+
+        SBE_NODISCARD const char *symbol() const SBE_NOEXCEPT
+        {
+            return m_buffer + m_offset + 7;
+        }
+
+        SBE_NODISCARD char *symbol() SBE_NOEXCEPT
+        {
+            return m_buffer + m_offset + 7;
+        }
+
+        SBE_NODISCARD char symbol(const std::uint64_t index) const
+        {
+            if (index >= 6)
+            {
+                throw std::runtime_error("index out of range for symbol [E104]");
+            }
+
+            char val;
+            std::memcpy(&val, m_buffer + m_offset + 7 + (index * 1), sizeof(char));
+            return (val);
+        }
+
+        Trades &symbol(const std::uint64_t index, const char value)
+        {
+            if (index >= 6)
+            {
+                throw std::runtime_error("index out of range for symbol [E105]");
+            }
+
+            char val = (value);
+            std::memcpy(m_buffer + m_offset + 7 + (index * 1), &val, sizeof(char));
+            return *this;
+        }
+
+        std::uint64_t getSymbol(char *const dst, const std::uint64_t length) const
+        {
+            if (length > 6)
+            {
+                throw std::runtime_error("length too large for getSymbol [E106]");
+            }
+
+            std::memcpy(dst, m_buffer + m_offset + 7, sizeof(char) * static_cast<std::size_t>(length));
+            return length;
+        }
+
+        Trades &putSymbol(const char *const src) SBE_NOEXCEPT
+        {
+            std::memcpy(m_buffer + m_offset + 7, src, sizeof(char) * 6);
+            return *this;
+        }
+
+        SBE_NODISCARD std::string getSymbolAsString() const
+        {
+            const char *buffer = m_buffer + m_offset + 7;
+            std::size_t length = 0;
+
+            for (; length < 6 && *(buffer + length) != '\0'; ++length);
+            std::string result(buffer, length);
+
+            return result;
+        }
+
+        std::string getSymbolAsJsonEscapedString()
+        {
+            std::ostringstream oss;
+            std::string s = getSymbolAsString();
+
+            for (const auto c : s)
+            {
+                switch (c)
+                {
+                    case '"': oss << "\\\""; break;
+                    case '\\': oss << "\\\\"; break;
+                    case '\b': oss << "\\b"; break;
+                    case '\f': oss << "\\f"; break;
+                    case '\n': oss << "\\n"; break;
+                    case '\r': oss << "\\r"; break;
+                    case '\t': oss << "\\t"; break;
+
+                    default:
+                        if ('\x00' <= c && c <= '\x1f')
+                        {
+                            oss << "\\u" << std::hex << std::setw(4)
+                                << std::setfill('0') << (int)(c);
+                        }
+                        else
+                        {
+                            oss << c;
+                        }
+                }
+            }
+
+            return oss.str();
+        }
+
+        #if __cplusplus >= 201703L
+        SBE_NODISCARD std::string_view getSymbolAsStringView() const SBE_NOEXCEPT
+        {
+            const char *buffer = m_buffer + m_offset + 7;
+            std::size_t length = 0;
+
+            for (; length < 6 && *(buffer + length) != '\0'; ++length);
+            std::string_view result(buffer, length);
+
+            return result;
+        }
+        #endif
+
+        #if __cplusplus >= 201703L
+        Trades &putSymbol(const std::string_view str)
+        {
+            const std::size_t srcLength = str.length();
+            if (srcLength > 6)
+            {
+                throw std::runtime_error("string too large for putSymbol [E106]");
+            }
+
+            std::memcpy(m_buffer + m_offset + 7, str.data(), srcLength);
+            for (std::size_t start = srcLength; start < 6; ++start)
+            {
+                m_buffer[m_offset + 7 + start] = 0;
+            }
+
+            return *this;
+        }
+        #else
+        Trades &putSymbol(const std::string &str)
+        {
+            const std::size_t srcLength = str.length();
+            if (srcLength > 6)
+            {
+                throw std::runtime_error("string too large for putSymbol [E106]");
+            }
+
+            std::memcpy(m_buffer + m_offset + 7, str.c_str(), srcLength);
+            for (std::size_t start = srcLength; start < 6; ++start)
+            {
+                m_buffer[m_offset + 7 + start] = 0;
+            }
+
+            return *this;
+        }
+        #endif
+
+        SBE_NODISCARD static const char *priceMetaAttribute(const MetaAttribute metaAttribute) SBE_NOEXCEPT
+        {
+            switch (metaAttribute)
+            {
+                case MetaAttribute::PRESENCE: return "required";
+                default: return "";
+            }
+        }
+
+        static SBE_CONSTEXPR std::uint16_t priceId() SBE_NOEXCEPT
+        {
+            return 3;
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t priceSinceVersion() SBE_NOEXCEPT
+        {
+            return 0;
+        }
+
+        SBE_NODISCARD bool priceInActingVersion() SBE_NOEXCEPT
+        {
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#endif
+            return m_actingVersion >= priceSinceVersion();
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::size_t priceEncodingOffset() SBE_NOEXCEPT
+        {
+            return 13;
+        }
+
+        static SBE_CONSTEXPR float priceNullValue() SBE_NOEXCEPT
+        {
+            return SBE_FLOAT_NAN;
+        }
+
+        static SBE_CONSTEXPR float priceMinValue() SBE_NOEXCEPT
+        {
+            return 1.401298464324817E-45f;
+        }
+
+        static SBE_CONSTEXPR float priceMaxValue() SBE_NOEXCEPT
+        {
+            return 3.4028234663852886E38f;
+        }
+
+        static SBE_CONSTEXPR std::size_t priceEncodingLength() SBE_NOEXCEPT
+        {
+            return 4;
+        }
+
+        SBE_NODISCARD float price() const SBE_NOEXCEPT
+        {
+            union sbe_float_as_uint_u val;
+            std::memcpy(&val, m_buffer + m_offset + 13, sizeof(float));
+            val.uint_value = SBE_LITTLE_ENDIAN_ENCODE_32(val.uint_value);
+            return val.fp_value;
+        }
+
+        Trades &price(const float value) SBE_NOEXCEPT
+        {
+            union sbe_float_as_uint_u val;
+            val.fp_value = value;
+            val.uint_value = SBE_LITTLE_ENDIAN_ENCODE_32(val.uint_value);
+            std::memcpy(m_buffer + m_offset + 13, &val, sizeof(float));
+            return *this;
+        }
+
+        SBE_NODISCARD static const char *currencyMetaAttribute(const MetaAttribute metaAttribute) SBE_NOEXCEPT
+        {
+            switch (metaAttribute)
+            {
+                case MetaAttribute::PRESENCE: return "required";
+                default: return "";
+            }
+        }
+
+        static SBE_CONSTEXPR std::uint16_t currencyId() SBE_NOEXCEPT
+        {
+            return 4;
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t currencySinceVersion() SBE_NOEXCEPT
+        {
+            return 0;
+        }
+
+        SBE_NODISCARD bool currencyInActingVersion() SBE_NOEXCEPT
+        {
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#endif
+            return m_actingVersion >= currencySinceVersion();
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::size_t currencyEncodingOffset() SBE_NOEXCEPT
+        {
+            return 17;
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::size_t currencyEncodingLength() SBE_NOEXCEPT
+        {
+            return 1;
+        }
+
+        SBE_NODISCARD std::uint8_t currencyRaw() const SBE_NOEXCEPT
+        {
+            std::uint8_t val;
+            std::memcpy(&val, m_buffer + m_offset + 17, sizeof(std::uint8_t));
+            return (val);
+        }
+
+        SBE_NODISCARD Currency::Value currency() const
+        {
+            std::uint8_t val;
+            std::memcpy(&val, m_buffer + m_offset + 17, sizeof(std::uint8_t));
+            return Currency::get((val));
+        }
+
+        Trades &currency(const Currency::Value value) SBE_NOEXCEPT
+        {
+            std::uint8_t val = (value);
+            std::memcpy(m_buffer + m_offset + 17, &val, sizeof(std::uint8_t));
+            return *this;
+        }
+
+        SBE_NODISCARD static const char *quantityMetaAttribute(const MetaAttribute metaAttribute) SBE_NOEXCEPT
+        {
+            switch (metaAttribute)
+            {
+                case MetaAttribute::PRESENCE: return "required";
+                default: return "";
+            }
+        }
+
+        static SBE_CONSTEXPR std::uint16_t quantityId() SBE_NOEXCEPT
+        {
+            return 5;
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t quantitySinceVersion() SBE_NOEXCEPT
+        {
+            return 0;
+        }
+
+        SBE_NODISCARD bool quantityInActingVersion() SBE_NOEXCEPT
+        {
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#endif
+            return m_actingVersion >= quantitySinceVersion();
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+        }
+
+        SBE_NODISCARD static SBE_CONSTEXPR std::size_t quantityEncodingOffset() SBE_NOEXCEPT
+        {
+            return 18;
+        }
+
+        static SBE_CONSTEXPR std::int32_t quantityNullValue() SBE_NOEXCEPT
+        {
+            return SBE_NULLVALUE_INT32;
+        }
+
+        static SBE_CONSTEXPR std::int32_t quantityMinValue() SBE_NOEXCEPT
+        {
+            return INT32_C(-2147483647);
+        }
+
+        static SBE_CONSTEXPR std::int32_t quantityMaxValue() SBE_NOEXCEPT
+        {
+            return INT32_C(2147483647);
+        }
+
+        static SBE_CONSTEXPR std::size_t quantityEncodingLength() SBE_NOEXCEPT
+        {
+            return 4;
+        }
+
+        SBE_NODISCARD std::int32_t quantity() const SBE_NOEXCEPT
+        {
+            std::int32_t val;
+            std::memcpy(&val, m_buffer + m_offset + 18, sizeof(std::int32_t));
+            return SBE_LITTLE_ENDIAN_ENCODE_32(val);
+        }
+
+        Trades &quantity(const std::int32_t value) SBE_NOEXCEPT
+        {
+            std::int32_t val = SBE_LITTLE_ENDIAN_ENCODE_32(value);
+            std::memcpy(m_buffer + m_offset + 18, &val, sizeof(std::int32_t));
+            return *this;
+        }
+
+
+    template<typename CharT, typename Traits>
+    friend std::basic_ostream<CharT, Traits> & operator << (
+        std::basic_ostream<CharT, Traits> &builder, Trades writer)
+    {
+        builder << '{';
+        builder << R"("exchange": )";
+        builder << '"' <<
+            writer.getExchangeAsJsonEscapedString().c_str() << '"';
+
+        builder << ", ";
+        builder << R"("symbol": )";
+        builder << '"' <<
+            writer.getSymbolAsJsonEscapedString().c_str() << '"';
+
+        builder << ", ";
+        builder << R"("price": )";
+        builder << +writer.price();
+
+        builder << ", ";
+        builder << R"("currency": )";
+        builder << '"' << writer.currency() << '"';
+
+        builder << ", ";
+        builder << R"("quantity": )";
+        builder << +writer.quantity();
+
+        builder << '}';
+
+        return builder;
+    }
+
+    void skip()
+    {
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR bool isConstLength() SBE_NOEXCEPT
+    {
+        return true;
+    }
+
+    SBE_NODISCARD static std::size_t computeLength()
+    {
+#if defined(__GNUG__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wtype-limits"
+#endif
+        std::size_t length = sbeBlockLength();
+
+        return length;
+#if defined(__GNUG__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+    }
+    };
+
+private:
+    Trades m_trades;
+
+public:
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint16_t tradesId() SBE_NOEXCEPT
+    {
+        return 10;
+    }
+
+    SBE_NODISCARD inline Trades &trades()
+    {
+        m_trades.wrapForDecode(m_buffer, sbePositionPtr(), m_actingVersion, m_bufferLength);
+        return m_trades;
+    }
+
+    Trades &tradesCount(const std::uint16_t count)
+    {
+        m_trades.wrapForEncode(m_buffer, count, sbePositionPtr(), m_actingVersion, m_bufferLength);
+        return m_trades;
+    }
+
+    SBE_NODISCARD static SBE_CONSTEXPR std::uint64_t tradesSinceVersion() SBE_NOEXCEPT
+    {
+        return 0;
+    }
+
+    SBE_NODISCARD bool tradesInActingVersion() const SBE_NOEXCEPT
+    {
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#endif
+        return m_actingVersion >= tradesSinceVersion();
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+    }
+
+template<typename CharT, typename Traits>
+friend std::basic_ostream<CharT, Traits> & operator << (
+    std::basic_ostream<CharT, Traits> &builder, TradeDataBatch _writer)
+{
+    TradeDataBatch writer(
+        _writer.m_buffer,
+        _writer.m_offset,
+        _writer.m_bufferLength,
+        _writer.m_actingBlockLength,
+        _writer.m_actingVersion);
+
+    builder << '{';
+    builder << R"("Name": "TradeDataBatch", )";
+    builder << R"("sbeTemplateId": )";
+    builder << writer.sbeTemplateId();
+    builder << ", ";
+
+    {
+        bool atLeastOne = false;
+        builder << R"("trades": [)";
+        writer.trades().forEach(
+            [&](Trades &trades)
+            {
+                if (atLeastOne)
+                {
+                    builder << ", ";
+                }
+                atLeastOne = true;
+                builder << trades;
+            });
+        builder << ']';
+    }
+
+    builder << '}';
+
+    return builder;
+}
+
+void skip()
+{
+    auto &tradesGroup { trades() };
+    while (tradesGroup.hasNext())
+    {
+        tradesGroup.next().skip();
+    }
+}
+
+SBE_NODISCARD static SBE_CONSTEXPR bool isConstLength() SBE_NOEXCEPT
+{
+    return false;
+}
+
+SBE_NODISCARD static std::size_t computeLength(std::size_t tradesLength = 0)
+{
+#if defined(__GNUG__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wtype-limits"
+#endif
+    std::size_t length = sbeBlockLength();
+
+    length += Trades::sbeHeaderSize();
+    if (tradesLength > 65534LL)
+    {
+        throw std::runtime_error("tradesLength outside of allowed range [E110]");
+    }
+    length += tradesLength *Trades::sbeBlockLength();
+
+    return length;
+#if defined(__GNUG__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+}
+};
+}
+#endif
@@ -0,0 +1,143 @@
+#ifndef SYMBOLOGY_HPP
+#define SYMBOLOGY_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+// String handling for the short, fixed-width char arrays of TradeDataStruct
+// without strcmp()/strlen(): a field of up to 8 chars is loaded into one
+// uint64_t (zero padded) and compared, hashed or measured as an integer.
+
+// Fixed-width load, the width is known at compile time. Odd widths are two
+// overlapping 4-byte loads combined in a register: memcpy() into a zeroed
+// uint64_t compiles to narrow stores followed by a wide reload, which the
+// CPU can't forward and stalls on.
+template <size_t N>
+uint64_t loadPacked(const char (&s)[N]) {
+    static_assert(N <= sizeof(uint64_t));
+    if constexpr (N == sizeof(uint64_t) || N < sizeof(uint32_t)) {
+        uint64_t packed = 0;
+        memcpy(&packed, s, N);
+        return packed;
+    } else {
+        uint32_t lo, hi;
+        memcpy(&lo, s, sizeof(lo));
+        memcpy(&hi, s + N - sizeof(hi), sizeof(hi));
+        // Overlapping bytes are the same in both, so OR is fine
+        return lo | static_cast<uint64_t>(hi) << (8 * (N - sizeof(hi)));
+    }
+}
+
+// The same packing for string literals, at compile time. Bytes after the
+// first '\0' are zero, like loadPacked() of a zero-filled array.
+constexpr uint64_t packLiteral(const char *s) {
+    uint64_t packed = 0;
+    for (size_t i = 0; i < sizeof(uint64_t) && s[i] != '\0'; ++i)
+        packed |= static_cast<uint64_t>(static_cast<uint8_t>(s[i])) << (8 * i);
+    return packed;
+}
+
+// The classic "has zero byte" bit trick: marks every zero byte of packed
+// with its top bit. Borrows can also mark bytes above a real zero byte, never
+// below one, so the lowest mark is always the first '\0'. Little-endian only.
+constexpr uint64_t zeroByteMarks(const uint64_t packed) {
+    static_assert(endian::native == endian::little);
+    constexpr uint64_t ones = 0x0101010101010101ULL;
+    constexpr uint64_t highs = 0x8080808080808080ULL;
+    return (packed - ones) & ~packed & highs;
+}
+
+// Length up to the first '\0' (strnlen(s, N)) from the packed value: the
+// lowest marked byte is the terminator.
+template <size_t N>
+size_t packedLength(const char (&s)[N]) {
+    const uint64_t zeroBytes = zeroByteMarks(loadPacked(s));
+    // N < 8 always leaves a zero byte after the array's own bytes
+    const size_t len = zeroBytes == 0 ? sizeof(uint64_t) : countr_zero(zeroBytes) / 8;
+    return len < N ? len : N;
+}
+
+// Clears whatever follows the first '\0', as strcmp() ignores it: a field
+// read from the wire needn't be zero padded like packLiteral() is.
+constexpr uint64_t packedString(const uint64_t packed) {
+    const uint64_t zeroBytes = zeroByteMarks(packed);
+    // The lowest mark is bit 7 of the terminator byte, (mark >> 7) - 1 keeps
+    // the bytes below it
+    return zeroBytes == 0 ? packed : packed & (((zeroBytes & -zeroBytes) >> 7) - 1);
+}
+
+// Perfect hash over a set of strings known at compile time: a multiplier is
+// searched (at compile time) such that the top bits of key * multiplier are
+// distinct for every key, then lookup is one multiply, one shift and one
+// compare against the stored key to reject strings outside the set.
+template <size_t N>
+class PerfectHash {
+    static constexpr size_t bits = bit_width(2 * N - 1); // >= 2N slots, keeps the search short
+    static constexpr size_t slots = size_t{1} << bits;
+
+public:
+    static constexpr uint8_t notFound = 0xff;
+
+    consteval explicit PerfectHash(const array<const char *, N> &names) {
+        static_assert(N < notFound);
+        // Candidates from splitmix64, so that consecutive ones differ in their
+        // high bits, which are the ones that pick the slot
+        for (uint64_t seed = 0;; ++seed) {
+            uint64_t candidate = (seed + 1) * 0x9e3779b97f4a7c15ULL;
+            candidate = (candidate ^ (candidate >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            candidate = (candidate ^ (candidate >> 27)) * 0x94d049bb133111ebULL;
+            if (tryMultiplier((candidate ^ (candidate >> 31)) | 1, names))
+                return;
+        }
+    }
+
+    // Index of s in the names given to the constructor, or notFound. Like
+    // strcmp(), only the bytes up to the first '\0' count.
+    template <size_t W>
+    uint8_t find(const char (&s)[W]) const {
+        return findPacked(packedString(loadPacked(s)));
+    }
+
+    // packed must be zero after the first '\0', see packedString()
+    constexpr uint8_t findPacked(const uint64_t packed) const {
+        const size_t slot = slotOf(packed);
+        return keys[slot] == packed ? codes[slot] : notFound;
+    }
+
+private:
+    constexpr size_t slotOf(const uint64_t packed) const { return (packed * multiplier) >> (64 - bits); }
+
+    consteval bool tryMultiplier(const uint64_t candidate, const array<const char *, N> &names) {
+        multiplier = candidate;
+        keys.fill(0);
+        codes.fill(notFound);
+        for (size_t i = 0; i < N; ++i) {
+            const uint64_t packed = packLiteral(names[i]);
+            const size_t slot = slotOf(packed);
+            if (codes[slot] != notFound)
+                return false;
+            keys[slot] = packed;
+            codes[slot] = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+
+    uint64_t multiplier = 0;
+    array<uint64_t, slots> keys{};
+    array<uint8_t, slots> codes{};
+};
+
+// Codes, in schema order (USD = 0, EUR = 1, HKD = 2 in every schema)
+constexpr array<const char *, 3> currencies = {"USD", "EUR", "HKD"};
+constexpr array<const char *, 4> exchanges = {"NASDAQ", "HKEX", "LSE", "NYSE"};
+constexpr array<const char *, 4> symbols = {"MSFT", "0005", "BP", "GS"};
+
+constexpr PerfectHash<currencies.size()> currencyHash{currencies};
+constexpr PerfectHash<exchanges.size()> exchangeHash{exchanges};
+constexpr PerfectHash<symbols.size()> symbolHash{symbols};
+
+#endif // SYMBOLOGY_HPP
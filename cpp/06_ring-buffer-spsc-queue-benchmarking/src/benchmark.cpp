@@ -0,0 +1,140 @@
+#include "cpu_utils.h"
+#include "payload.h"
+#include "pc_queue.h"
+#include "pc_queue_impl/atomic_queue.h"
+#include "pc_queue_impl/mutex_deque.h"
+#include "pc_queue_impl/my_ringbuffer.h"
+#include "pc_queue_impl/reader_writer_queue.h"
+#include "wait_strategy.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <time.h>
+
+// Every benchmark iteration pushes msgs_per_iter elements from the benchmark
+// (producer) thread to PcQueue's consumer thread. Queue construction and
+// thread start-up are excluded from the timing.
+constexpr size_t msgs_per_iter = 1'000'000;
+
+static int64_t thread_cpu_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
+}
+
+template <template <class, size_t> class T_QUEUE, class T, class T_WAIT>
+static void BM_PcQueue(benchmark::State &state) {
+  const int producer_core = static_cast<int>(state.range(0));
+  const int consumer_core = static_cast<int>(state.range(1));
+
+  cpu_set_t original_mask;
+  pthread_getaffinity_np(pthread_self(), sizeof(original_mask),
+                         &original_mask);
+  if (!pin_this_thread(producer_core)) {
+    state.SkipWithError("failed to pin producer thread");
+    return;
+  }
+
+  uint64_t sink = 0;
+  auto cb = [&sink](const T &ele, std::size_t) { sink += touch(ele); };
+  using Queue = PcQueue<T_QUEUE, T, capacity_for<T>, T_WAIT, decltype(cb)>;
+  PayloadFactory<T> factory;
+  int64_t consumer_cpu_ns = 0;
+  int64_t producer_cpu_ns = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto pcq = std::make_unique<Queue>(msgs_per_iter, cb);
+    pcq->start(consumer_core);
+    const int64_t producer_cpu_start = thread_cpu_ns();
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < msgs_per_iter; ++i) {
+      pcq->enqueue(factory(i));
+    }
+    pcq->wait();
+
+    state.PauseTiming();
+    producer_cpu_ns += thread_cpu_ns() - producer_cpu_start;
+    consumer_cpu_ns += pcq->consumer_cpu_ns();
+    pcq.reset();
+    state.ResumeTiming();
+  }
+  benchmark::DoNotOptimize(sink);
+  pthread_setaffinity_np(pthread_self(), sizeof(original_mask),
+                         &original_mask);
+
+  const double msgs = static_cast<double>(state.iterations() * msgs_per_iter);
+  state.counters["items/s"] =
+      benchmark::Counter(msgs, benchmark::Counter::kIsRate);
+  state.counters["bytes/s"] =
+      benchmark::Counter(msgs * sizeof(T), benchmark::Counter::kIsRate,
+                         benchmark::Counter::kIs1024);
+  // CPU time per message, the wait strategies trade consumer CPU for latency
+  state.counters["producer_cpu_ns/item"] = producer_cpu_ns / msgs;
+  state.counters["consumer_cpu_ns/item"] = consumer_cpu_ns / msgs;
+}
+
+// {producer_core, consumer_core}, -1 leaves the thread unpinned. The second
+// pair tends to land on a different physical core, the first on a
+// hyper-thread sibling or neighbour, depending on the CPU's numbering.
+static void CoreArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"pcore", "ccore"});
+  const auto cpu_count = static_cast<int>(std::thread::hardware_concurrency());
+  if (cpu_count < 2) {
+    b->Args({-1, -1});
+    return;
+  }
+  b->Args({0, 1});
+  if (cpu_count > 2) {
+    b->Args({0, cpu_count / 2});
+  }
+}
+
+#define PC_QUEUE_BENCHMARK(QUEUE, TYPE, WAIT)                                  \
+  BENCHMARK_TEMPLATE(BM_PcQueue, QUEUE, TYPE, WAIT)                            \
+      ->Apply(CoreArgs)                                                        \
+      ->UseRealTime()                                                          \
+      ->Unit(benchmark::kMillisecond)
+
+#define PC_QUEUE_BENCHMARK_WAIT_STRATEGIES(QUEUE)                              \
+  PC_QUEUE_BENCHMARK(QUEUE, uint32_t, SpinWait);                               \
+  PC_QUEUE_BENCHMARK(QUEUE, uint32_t, PauseWait);                              \
+  PC_QUEUE_BENCHMARK(QUEUE, uint32_t, YieldWait);                              \
+  PC_QUEUE_BENCHMARK(QUEUE, uint32_t, ParkWait)
+
+// The payload types of main.cpp's former payload mode: PODs from a quarter
+// to eight cache lines, the same sizes behind a pointer, and a string
+#define PC_QUEUE_BENCHMARK_PAYLOADS(QUEUE)                                     \
+  PC_QUEUE_BENCHMARK(QUEUE, Pod<16>, SpinWait);                                \
+  PC_QUEUE_BENCHMARK(QUEUE, Pod<64>, SpinWait);                                \
+  PC_QUEUE_BENCHMARK(QUEUE, Pod<128>, SpinWait);                               \
+  PC_QUEUE_BENCHMARK(QUEUE, Pod<256>, SpinWait);                               \
+  PC_QUEUE_BENCHMARK(QUEUE, Pod<512>, SpinWait);                               \
+  PC_QUEUE_BENCHMARK(QUEUE, std::unique_ptr<Pod<64>>, SpinWait);               \
+  PC_QUEUE_BENCHMARK(QUEUE, std::unique_ptr<Pod<512>>, SpinWait);              \
+  PC_QUEUE_BENCHMARK(QUEUE, std::string, SpinWait)
+
+PC_QUEUE_BENCHMARK_WAIT_STRATEGIES(aqb);
+PC_QUEUE_BENCHMARK_WAIT_STRATEGIES(myrb);
+PC_QUEUE_BENCHMARK_WAIT_STRATEGIES(rwq);
+PC_QUEUE_BENCHMARK_WAIT_STRATEGIES(dq);
+
+PC_QUEUE_BENCHMARK_PAYLOADS(aqb);
+PC_QUEUE_BENCHMARK_PAYLOADS(myrb);
+PC_QUEUE_BENCHMARK_PAYLOADS(rwq);
+PC_QUEUE_BENCHMARK_PAYLOADS(dq);
+
+int main(int argc, char **argv) {
+  benchmark::AddCustomContext("cpu_model", cpu_model());
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
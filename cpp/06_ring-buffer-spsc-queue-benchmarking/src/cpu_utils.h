@@ -0,0 +1,51 @@
+#ifndef CPU_UTILS_H
+#define CPU_UTILS_H
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// "model name" of the first CPU in /proc/cpuinfo, empty if unavailable
+inline std::string cpu_model() {
+  char buffer[PATH_MAX];
+  FILE *fp = fopen("/proc/cpuinfo", "r");
+
+  if (fp == NULL) {
+    perror("Failed to open /proc/cpuinfo");
+    return "";
+  }
+
+  std::string model;
+  while (fgets(buffer, PATH_MAX, fp) != NULL) {
+    if (strncmp(buffer, "model name", 10) == 0) {
+      char *model_name = strchr(buffer, ':');
+      if (model_name != NULL) {
+        model = model_name + 2; // Skip the colon and space
+        if (!model.empty() && model.back() == '\n') {
+          model.pop_back();
+        }
+        break;
+      }
+    }
+  }
+  fclose(fp);
+  return model;
+}
+
+// Pins the calling thread to core, a negative core leaves affinity untouched.
+// Returns false if the kernel rejected the mask (e.g. core doesn't exist).
+inline bool pin_this_thread(int core) {
+  if (core < 0) {
+    return true;
+  }
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+}
+
+#endif // CPU_UTILS_H
@@ -1,86 +1,77 @@
+#include "../../common/latency_histogram.h"
+#include "cpu_utils.h"
+#include "payload.h"
 #include "pc_queue.h"
 #include "pc_queue_impl/atomic_queue.h"
 #include "pc_queue_impl/mutex_deque.h"
 // #include "pc_queue_impl/ramalhete_queue.h"
 #include "pc_queue_impl/my_ringbuffer.h"
 #include "pc_queue_impl/reader_writer_queue.h"
+#include "wait_strategy.h"
 #include <chrono>
-#include <iostream>
+#include <memory>
 #include <print>
-#include <unistd.h>
+#include <string>
 
 using namespace std;
 
-void cb_on_dequeue(const uint32_t &ele, std::size_t msg_count) {
-  std::println("{},{}", ele, msg_count);
+// Low 32 bits of steady_clock in ns. Wraps every ~4.3 s, which is fine for a
+// one-way latency as long as the difference is taken in uint32_t.
+static inline uint32_t now_ns32() {
+  return static_cast<uint32_t>(
+      chrono::duration_cast<chrono::nanoseconds>(
+          chrono::steady_clock::now().time_since_epoch())
+          .count());
 }
 
-template <class T_QUEUE>
-auto benchmark(size_t iterations, uint32_t *elements, size_t element_count) {
-  auto start = chrono::high_resolution_clock::now();
+// The producer stamps every element with now_ns32() and sends one element
+// every interval_ns, the consumer records now_ns32() - stamp.
+template <template <class, size_t> class T_QUEUE, class T_WAIT>
+void latency_executor(string impl_name) {
+  constexpr size_t msg_count = 1'000'000;
+  constexpr uint32_t interval_ns = 1'000;
 
-  auto pcq = PcQueue<T_QUEUE>(iterations, cb_on_dequeue);
-  pcq.start();
-  start = chrono::high_resolution_clock::now();
-  for (uint32_t i = 0; i < iterations; i++) {
-    pcq.enqueue(elements[i % element_count]);
-  }
-  pcq.wait();
-  const auto end = chrono::high_resolution_clock::now();
-
-  return std::make_tuple(
-      pcq.handled_msg_count(),
-      chrono::duration_cast<chrono::nanoseconds>(end - start).count());
-}
-
-template <class T_QUEUE> void benchmark_executor(string impl_name) {
-  constexpr size_t iter_count = 10;
-  uint32_t ele_arr[] = {0, 2, 2, 2, 4, 5, 5, 7, 8, 9};
-  constexpr size_t ele_len = sizeof(ele_arr) / sizeof(ele_arr[0]);
-
-  cout << "===== " << impl_name << " =====\n";
-
-  for (size_t i = 0; i < 10; ++i) {
-    uint32_t ele_counter[ele_len] = {0};
-    auto [msg_count, elapsed_ns] =
-        benchmark<T_QUEUE>(iter_count, ele_arr, ele_len);
-    std::locale loc("");
-    std::cout.imbue(loc);
-    cout << "iter: " << i << ", elapsed_ms: " << elapsed_ns / 1000 / 1000
-         << ", handled_msg: " << msg_count
-         << ", ops/sec: " << msg_count * 1000 * 1000 * 1000 / elapsed_ns;
-    cout << "\n";
-  }
-  std::cout << "\n" << std::endl;
-}
-
-void print_cpu_model() {
-  char buffer[PATH_MAX];
-  FILE *fp = fopen("/proc/cpuinfo", "r");
-
-  if (fp == NULL) {
-    perror("Failed to open /proc/cpuinfo");
-    return;
-  }
-
-  while (fgets(buffer, PATH_MAX, fp) != NULL) {
-    if (strncmp(buffer, "model name", 10) == 0) {
-      char *model_name = strchr(buffer, ':');
-      if (model_name != NULL) {
-        printf("CPU Model: %s\n\n", model_name + 2); // Skip the colon and space
-        break;
+  LatencyHistogram<> hist;
+  auto record = [&hist](const uint32_t &sent_ns, std::size_t) {
+    hist.record(static_cast<uint32_t>(now_ns32() - sent_ns));
+  };
+  {
+    auto pcq = make_unique<PcQueue<T_QUEUE, uint32_t, capacity_for<uint32_t>,
+                                   T_WAIT, decltype(record)>>(msg_count,
+                                                              record);
+    pcq->start();
+    uint32_t next_send = now_ns32();
+    for (size_t i = 0; i < msg_count; ++i) {
+      while (static_cast<int32_t>(now_ns32() - next_send) < 0) {
       }
+      pcq->enqueue(now_ns32());
+      next_send += interval_ns;
     }
+    pcq->wait();
   }
-  fclose(fp);
+  println("{:<32} {:<10} p50: {:>6} ns, p90: {:>6} ns, p99: {:>6} ns, "
+          "p99.99: {:>8} ns, max: {:>8} ns",
+          impl_name, T_WAIT::name, hist.value_at_percentile(50),
+          hist.value_at_percentile(90), hist.value_at_percentile(99),
+          hist.value_at_percentile(99.99), hist.max());
+}
+
+template <template <class, size_t> class T_QUEUE>
+void latency_wait_strategies(string impl_name) {
+  latency_executor<T_QUEUE, SpinWait>(impl_name);
+  latency_executor<T_QUEUE, PauseWait>(impl_name);
+  latency_executor<T_QUEUE, YieldWait>(impl_name);
+  latency_executor<T_QUEUE, ParkWait>(impl_name);
 }
 
+// Throughput and payload-size benchmarks live in benchmark.cpp (Google
+// Benchmark), this binary only measures the one-way latency distribution.
 int main(void) {
-  print_cpu_model();
+  println("CPU Model: {}\n", cpu_model());
 
-  benchmark_executor<aqb>("max0x7ba/OptimistAtomicQueues");
-  benchmark_executor<myrb>("PoC::LockFree::RingBufferSPSC");
-  benchmark_executor<rwq>("moodycamel::ReaderWriterQueue");
-  benchmark_executor<dq>("std::deque with std::mutex");
+  latency_wait_strategies<aqb>("max0x7ba/OptimistAtomicQueues");
+  latency_wait_strategies<myrb>("PoC::LockFree::RingBufferSPSC");
+  latency_wait_strategies<rwq>("moodycamel::ReaderWriterQueue");
+  latency_wait_strategies<dq>("std::deque with std::mutex");
   return 0;
 }
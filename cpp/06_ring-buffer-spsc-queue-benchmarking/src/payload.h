@@ -0,0 +1,62 @@
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// Trivially copyable stand-in for a market-data struct of SIZE bytes
+template <size_t SIZE> struct Pod {
+  static_assert(SIZE > sizeof(uint64_t));
+  uint64_t seq;
+  char data[SIZE - sizeof(uint64_t)];
+};
+
+// Queue capacity that keeps every queue's slot array at about 4 MB,
+// regardless of element size
+template <class T>
+constexpr size_t capacity_for = std::bit_floor(4 * 1024 * 1024 / sizeof(T));
+
+// How the producer creates the i-th element. Pointer-passing types pay for
+// their allocation here, as they would in a real producer.
+template <class T> struct PayloadFactory;
+
+template <> struct PayloadFactory<uint32_t> {
+  uint32_t operator()(uint64_t i) { return static_cast<uint32_t>(i); }
+};
+
+template <size_t SIZE> struct PayloadFactory<Pod<SIZE>> {
+  Pod<SIZE> prototype{};
+  Pod<SIZE> operator()(uint64_t i) {
+    prototype.seq = i;
+    return prototype;
+  }
+};
+
+template <size_t SIZE> struct PayloadFactory<std::unique_ptr<Pod<SIZE>>> {
+  std::unique_ptr<Pod<SIZE>> operator()(uint64_t i) {
+    auto ptr = std::make_unique<Pod<SIZE>>();
+    ptr->seq = i;
+    return ptr;
+  }
+};
+
+template <> struct PayloadFactory<std::string> {
+  // Longer than libstdc++'s 15-char SSO buffer, so every string allocates
+  std::string operator()(uint64_t i) {
+    return "ABCDEFGHIJKLMNOPQRSTUVWXYZ-" + std::to_string(i);
+  }
+};
+
+// Reads one field of the element so the consumer can't skip the copy
+inline uint64_t touch(const uint32_t &ele) { return ele; }
+template <size_t SIZE> uint64_t touch(const Pod<SIZE> &ele) { return ele.seq; }
+template <size_t SIZE> uint64_t touch(const std::unique_ptr<Pod<SIZE>> &ele) {
+  return ele->seq;
+}
+inline uint64_t touch(const std::string &ele) { return ele.size(); }
+
+#endif // PAYLOAD_H
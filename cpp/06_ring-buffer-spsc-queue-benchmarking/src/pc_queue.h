@@ -1,32 +1,78 @@
 #ifndef PC_QUEUE_H
 #define PC_QUEUE_H
 
-#include <functional>
+#include "cpu_utils.h"
+#include "wait_strategy.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <thread>
+#include <time.h>
+#include <utility>
+
+// Each pc_queue_impl/*.h defines a queue class template Q<T, CAPACITY> and
+// specializes this with the two operations PcQueue needs from it:
+//   static bool try_dequeue(Q<T, CAPACITY> &q, T &msg);
+//   template <class U> static void enqueue(Q<T, CAPACITY> &q, U &&msg);
+// enqueue() must not drop messages: bounded queues spin until there is room.
+template <class T_QUEUE> struct PcQueueTraits;
 
-#define QUEUE_SIZE (1024 * 1024 * 16)
+struct NoopCallback {
+  template <class T> void operator()(const T &, std::size_t) const {}
+};
 
-template <class T_QUEUE> class PcQueue {
+// T_CALLBACK is invoked by the consumer as cb(ele, msg_count) for every
+// dequeued element, ele is a non-const lvalue so the callback may move from
+// it. It is stored by value and called directly, so a lambda gets inlined
+// into the consume loop instead of going through std::function.
+//
+// Some queues store their slots inline, so a PcQueue can be several MB large
+// and should live on the heap.
+template <template <class, size_t> class T_QUEUE, class T, size_t CAPACITY,
+          class T_WAIT = SpinWait, class T_CALLBACK = NoopCallback>
+class PcQueue {
 private:
-  T_QUEUE q;
+  using Queue = T_QUEUE<T, CAPACITY>;
+  Queue q;
+  T_WAIT m_wait;
   std::thread consumer;
   size_t m_enqueue_iterations;
   size_t msg_count = 0;
-  void consume();
-  std::mutex mut;
-  // uint32_t *element_counter;
-  std::function<void(const uint32_t &ele, std::size_t msg_count)>
-      m_cb_on_dequeue;
+  uint32_t m_enqueued_count = 0;
+  int64_t m_consumer_cpu_ns = 0;
+  T_CALLBACK m_cb_on_dequeue;
 
-public:
-  PcQueue(const size_t iterations,
-          const decltype(m_cb_on_dequeue) &cb_on_dequeue) {
-    // this->element_counter = element_counter;
-    m_cb_on_dequeue = cb_on_dequeue;
-    m_enqueue_iterations = iterations;
+  void consume() {
+    T msg{};
+    while (msg_count < m_enqueue_iterations) {
+      if (PcQueueTraits<Queue>::try_dequeue(q, msg)) [[likely]] {
+        ++msg_count;
+        m_cb_on_dequeue(msg, msg_count);
+        m_wait.reset();
+      } else {
+        m_wait.wait(static_cast<uint32_t>(msg_count));
+      }
+    }
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    m_consumer_cpu_ns = ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
   }
 
-  void start() { consumer = std::thread(&PcQueue::consume, this); }
+public:
+  using value_type = T;
+  static constexpr size_t capacity = CAPACITY;
+
+  PcQueue(const size_t iterations, T_CALLBACK cb_on_dequeue = T_CALLBACK())
+      : m_enqueue_iterations(iterations),
+        m_cb_on_dequeue(std::move(cb_on_dequeue)) {}
+
+  // consumer_core < 0 lets the scheduler place the consumer thread
+  void start(int consumer_core = -1) {
+    consumer = std::thread([this, consumer_core] {
+      pin_this_thread(consumer_core);
+      consume();
+    });
+  }
 
   void wait() {
     if (consumer.joinable()) {
@@ -37,8 +83,16 @@ public:
   ~PcQueue() { // wait();
   }
 
-  void enqueue(uint32_t msg);
+  PcQueue(const PcQueue &) = delete;
+  PcQueue &operator=(const PcQueue &) = delete;
+
+  template <class U> void enqueue(U &&msg) {
+    PcQueueTraits<Queue>::enqueue(q, std::forward<U>(msg));
+    m_wait.notify(++m_enqueued_count);
+  }
   size_t handled_msg_count() { return this->msg_count; }
+  // Only meaningful after wait() returns
+  int64_t consumer_cpu_ns() { return m_consumer_cpu_ns; }
 };
 
 #endif // RS_PC_QUEUE_H
@@ -4,26 +4,33 @@
 
 #include <atomic_queue/atomic_queue.h>
 
+#include <type_traits>
+
 // The below follows its own benchmark impl:
 // https://github.com/max0x7ba/atomic_queue/blob/master/src/benchmarks.cc
 using Element = uint32_t; // Queue element type.
 Element constexpr NIL =
     static_cast<Element>(-1); // Atomic elements require a special value that
                               // cannot be pushed/popped.
-using aqb = atomic_queue::AtomicQueue<Element, QUEUE_SIZE / 32, NIL, true, true,
-                                      false, true>;
 
-template <> inline void PcQueue<aqb>::consume() {
-  while (true) {
-    if (msg_count < m_enqueue_iterations) [[likely]] {
-      // What if q is empty()? The doc doesn't make it very clear...
-      const uint32_t msg = q.pop();
-      ++msg_count;
-      m_cb_on_dequeue(msg, msg_count);
-    } else [[unlikely]] {
-      break;
-    }
-  }
-}
+// AtomicQueue stores atomic elements directly and needs a NIL value, so it is
+// used for uint32_t only. AtomicQueue2 keeps a separate state per slot and
+// works for any (including move-only) type.
+template <class T, size_t CAPACITY>
+using aqb_base = std::conditional_t<
+    std::is_same_v<T, Element>,
+    atomic_queue::AtomicQueue<Element, CAPACITY, NIL, true, true, false, true>,
+    atomic_queue::AtomicQueue2<T, CAPACITY, true, true, false, true>>;
+
+template <class T, size_t CAPACITY> struct aqb : aqb_base<T, CAPACITY> {};
 
-template <> inline void PcQueue<aqb>::enqueue(uint32_t msg) { q.push(msg); }
+template <class T, size_t CAPACITY> struct PcQueueTraits<aqb<T, CAPACITY>> {
+  // pop() spins internally until an element shows up, try_pop() hands the
+  // empty case back to PcQueue's wait strategy instead
+  static bool try_dequeue(aqb<T, CAPACITY> &q, T &msg) {
+    return q.try_pop(msg);
+  }
+  template <class U> static void enqueue(aqb<T, CAPACITY> &q, U &&msg) {
+    q.push(std::forward<U>(msg));
+  }
+};
@@ -3,25 +3,24 @@
 #include <deque>
 #include <mutex>
 
-using dq = std::deque<uint32_t>;
+// Unbounded, CAPACITY is ignored
+template <class T, size_t CAPACITY> struct dq {
+  std::deque<T> q;
+  std::mutex mut;
+};
 
-template <> inline void PcQueue<dq>::consume() {
-  while (true) {
-    std::lock_guard<std::mutex> lk(mut);
-    if (msg_count < m_enqueue_iterations) [[likely]] {
-      if (!q.empty()) [[likely]] {
-        const uint32_t msg = q.front();
-        q.pop_front();
-        ++msg_count;
-        m_cb_on_dequeue(msg, msg_count);
-      }
-    } else [[unlikely]] {
-      break;
+template <class T, size_t CAPACITY> struct PcQueueTraits<dq<T, CAPACITY>> {
+  static bool try_dequeue(dq<T, CAPACITY> &d, T &msg) {
+    std::lock_guard<std::mutex> lk(d.mut);
+    if (d.q.empty()) {
+      return false;
     }
+    msg = std::move(d.q.front());
+    d.q.pop_front();
+    return true;
   }
-}
-
-template <> inline void PcQueue<dq>::enqueue(uint32_t msg) {
-  std::lock_guard<std::mutex> lk(mut);
-  q.push_back(msg);
-}
+  template <class U> static void enqueue(dq<T, CAPACITY> &d, U &&msg) {
+    std::lock_guard<std::mutex> lk(d.mut);
+    d.q.push_back(std::forward<U>(msg));
+  }
+};
@@ -2,34 +2,36 @@
 
 #include "../pc_queue.h"
 
-#include <print>
+template <class T, size_t CAPACITY>
+struct myrb : PoC::LockFree::RingBufferSPSC<T> {
+  // Consumer-side staging area: the consumer drains in batches so that head
+  // is published once per batch instead of once per element
+  static constexpr size_t batch_size = 64;
+  T batch[batch_size];
+  size_t batch_pos = 0;
+  size_t batch_len = 0;
 
-using myrb = PoC::LockFree::RingBufferSPSC<uint32_t>;
+  myrb() : PoC::LockFree::RingBufferSPSC<T>(CAPACITY) {}
+};
 
-template <>
-inline PcQueue<myrb>::PcQueue(size_t iterations,
-                              const decltype(m_cb_on_dequeue) &cb_on_dequeue)
-    : q(QUEUE_SIZE) {
-  m_cb_on_dequeue = cb_on_dequeue;
-  this->m_enqueue_iterations = iterations;
-}
+template <class T, size_t CAPACITY> struct PcQueueTraits<myrb<T, CAPACITY>> {
+  using Queue = myrb<T, CAPACITY>;
 
-template <> inline void PcQueue<myrb>::consume() {
-  uint32_t msg;
-  while (true) {
-    if (msg_count < m_enqueue_iterations) [[likely]] {
-      if (q.dequeue(msg)) [[likely]] {
-        ++msg_count;
-        m_cb_on_dequeue(msg, msg_count);
+  static bool try_dequeue(Queue &q, T &msg) {
+    if (q.batch_pos == q.batch_len) {
+      q.batch_len = q.dequeue_bulk(q.batch, Queue::batch_size);
+      q.batch_pos = 0;
+      if (q.batch_len == 0) {
+        return false;
       }
-    } else [[unlikely]] {
-      break;
     }
+    msg = std::move(q.batch[q.batch_pos++]);
+    return true;
   }
-}
-
-template <> inline void PcQueue<myrb>::enqueue(uint32_t msg) {
-  if (!q.enqueue(std::move(msg))) {
-    std::print("enqueueFailed\n");
+  template <class U> static void enqueue(Queue &q, U &&msg) {
+    // msg is only moved from if enqueue() succeeds
+    while (!q.enqueue(std::forward<U>(msg))) {
+      cpu_relax();
+    }
   }
-}
+};
@@ -4,20 +4,21 @@
 
 #include <readerwriterqueue/readerwriterqueue.h>
 
-using rwq = moodycamel::ReaderWriterQueue<uint32_t, 1024 * 1024>;
+// Preallocates CAPACITY slots and only uses try_enqueue(), which never
+// allocates, so it is bounded like the other queues
+template <class T, size_t CAPACITY>
+struct rwq : moodycamel::ReaderWriterQueue<T> {
+  rwq() : moodycamel::ReaderWriterQueue<T>(CAPACITY) {}
+};
 
-template <> inline void PcQueue<rwq>::consume() {
-  uint32_t msg;
-  while (true) {
-    if (msg_count < m_enqueue_iterations) [[likely]] {
-      if (q.try_dequeue(msg)) [[likely]] {
-        ++msg_count;
-        m_cb_on_dequeue(msg, msg_count);
-      }
-    } else [[unlikely]] {
-      break;
+template <class T, size_t CAPACITY> struct PcQueueTraits<rwq<T, CAPACITY>> {
+  static bool try_dequeue(rwq<T, CAPACITY> &q, T &msg) {
+    return q.try_dequeue(msg);
+  }
+  template <class U> static void enqueue(rwq<T, CAPACITY> &q, U &&msg) {
+    // msg is only moved from if try_enqueue() succeeds
+    while (!q.try_enqueue(std::forward<U>(msg))) {
+      cpu_relax();
     }
   }
-}
-
-template <> inline void PcQueue<rwq>::enqueue(uint32_t msg) { q.enqueue(msg); }
+};
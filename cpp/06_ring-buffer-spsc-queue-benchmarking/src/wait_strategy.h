@@ -0,0 +1,104 @@
+#ifndef WAIT_STRATEGY_H
+#define WAIT_STRATEGY_H
+
+#include <atomic>
+#include <cstdint>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// What a PcQueue consumer does when it finds the queue empty.
+//
+// Every strategy exposes the same three hooks:
+// - notify(enqueued): producer side, called after every enqueue with the
+//   running count of enqueued messages
+// - wait(consumed):   consumer side, called after a failed dequeue with the
+//   running count of consumed messages
+// - reset():          consumer side, called after a successful dequeue
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// Burns a full core, lowest wake-up latency
+struct SpinWait {
+  static constexpr const char *name = "spin";
+  void notify(uint32_t) {}
+  void wait(uint32_t) {}
+  void reset() {}
+};
+
+// Still burns a core, but pause de-pipelines the spin loop, which saves power
+// and leaves more execution resources to a hyper-thread sibling
+struct PauseWait {
+  static constexpr const char *name = "spin-pause";
+  void notify(uint32_t) {}
+  void wait(uint32_t) { cpu_relax(); }
+  void reset() {}
+};
+
+// Spins for a while, then gives the core away with sched_yield(). Only helps
+// if there is something else runnable on the core.
+struct YieldWait {
+  static constexpr const char *name = "spin-yield";
+  static constexpr uint32_t spin_limit = 1024;
+  uint32_t spins = 0;
+  void notify(uint32_t) {}
+  void wait(uint32_t) {
+    if (spins < spin_limit) {
+      ++spins;
+      cpu_relax();
+    } else {
+      sched_yield();
+    }
+  }
+  void reset() { spins = 0; }
+};
+
+// Spins for a while, then parks the consumer on a futex via
+// std::atomic::wait(). The producer publishes its enqueue count and only
+// issues the (syscall) wake-up if the consumer is actually asleep.
+struct ParkWait {
+  static constexpr const char *name = "spin-park";
+  static constexpr uint32_t spin_limit = 1024;
+
+  // Producer-written
+  alignas(64) std::atomic<uint32_t> enqueued = 0;
+  // Consumer-written
+  alignas(64) std::atomic<bool> sleeping = false;
+  uint32_t spins = 0;
+
+  void notify(uint32_t enqueued_count) {
+    enqueued.store(enqueued_count, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst)) [[unlikely]] {
+      enqueued.notify_one();
+    }
+  }
+
+  void wait(uint32_t consumed_count) {
+    if (spins < spin_limit) {
+      ++spins;
+      cpu_relax();
+      return;
+    }
+    // Dekker-style handshake with notify(): either the producer sees
+    // sleeping == true and wakes us up, or we see its new enqueued count and
+    // wait() returns immediately.
+    sleeping.store(true, std::memory_order_seq_cst);
+    const uint32_t seen = enqueued.load(std::memory_order_seq_cst);
+    if (seen == consumed_count) {
+      enqueued.wait(seen, std::memory_order_seq_cst);
+    }
+    sleeping.store(false, std::memory_order_relaxed);
+  }
+
+  void reset() { spins = 0; }
+};
+
+#endif // WAIT_STRATEGY_H
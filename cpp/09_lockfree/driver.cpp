@@ -6,10 +6,16 @@
 #include <boost/lockfree/queue.hpp>
 #include <fmt/format.h>
 
-#include <array>
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <iostream>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -23,63 +29,191 @@ concept is_queue = requires(Q q, const T &value, T &result) {
   { q.pop(result) } -> std::same_as<bool>;
 };
 
+// Element of PAYLOAD_SIZE bytes. id indexes into the enqueue timestamp table,
+// so even the 4-byte payload can be traced from producer to consumer.
+template <size_t PAYLOAD_SIZE> struct Payload {
+  static_assert(PAYLOAD_SIZE >= sizeof(uint32_t));
+  uint32_t id;
+  char padding[PAYLOAD_SIZE - sizeof(uint32_t)];
+};
+
+template <> struct Payload<sizeof(uint32_t)> {
+  uint32_t id;
+};
+
+template <typename T> using BoostQueue = boost::lockfree::queue<T>;
+
+struct RunContext {
+  size_t total_msg;
+  // Written by producers before push(), read by consumers after pop(), the
+  // queue's own release/acquire makes the write visible.
+  std::vector<int64_t> enqueue_ns;
+  std::vector<uint8_t> seen;
+  std::atomic<size_t> consumed = 0;
+  std::atomic<bool> go = false;
+
+  explicit RunContext(size_t total)
+      : total_msg(total), enqueue_ns(total), seen(total, 0) {}
+};
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static size_t cpu_count() {
+  const auto n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+// Thread i goes to core i. Runs with more threads than cores wrap around and
+// share cores, benchmarker() flags them.
+static void pin_to_core(size_t core) {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core % cpu_count(), &cpuset);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+}
+
 template <typename Q, typename T>
   requires is_queue<Q, T>
-void producer_func(Q &q, int push_size) {
-  for (int i = 0; i < push_size; ++i) {
-    q.push(i);
+void producer_func(Q &q, RunContext &ctx, size_t core, uint32_t first_id,
+                   uint32_t push_size) {
+  pin_to_core(core);
+  T ele{};
+  while (!ctx.go.load(std::memory_order_acquire)) {
+  }
+  for (uint32_t i = 0; i < push_size; ++i) {
+    ele.id = first_id + i;
+    ctx.enqueue_ns[ele.id] = now_ns();
+    q.push(ele);
   }
 }
 
 template <typename Q, typename T>
   requires is_queue<Q, T>
-void consumer_func(Q &q, std::vector<int> &hist, int procuder_thread_count,
-                   int ele_count) {
-  int poped_count = 0;
-  while (poped_count < procuder_thread_count * ele_count) {
-    int res;
+void consumer_func(Q &q, RunContext &ctx, size_t core,
+                   std::vector<int64_t> &latencies) {
+  pin_to_core(core);
+  while (!ctx.go.load(std::memory_order_acquire)) {
+  }
+  T res;
+  while (ctx.consumed.load(std::memory_order_relaxed) < ctx.total_msg) {
     if (q.pop(res)) {
-      ++poped_count;
-      ++hist[res];
+      latencies.push_back(now_ns() - ctx.enqueue_ns[res.id]);
+      ++ctx.seen[res.id];
+      ctx.consumed.fetch_add(1, std::memory_order_relaxed);
     }
-    // fmt::print("{} vs {}\n", poped_count, procuder_thread_count * ele_count);
   }
 }
 
-template <typename Q, typename T>
-  requires is_queue<Q, T>
-void benchmarker() {
-  constexpr int thread_count = 1;
-  constexpr int count = 1000000;
-  std::vector<int> hist(count, 0);
-  std::array<std::thread, count> threads;
-  Q queue(thread_count * count);
-  auto t0 = std::chrono::steady_clock::now();
-  for (int i = 0; i < thread_count; ++i) {
-    threads[i] = std::thread(&producer_func<Q, T>, std::ref(queue), count);
+static int64_t percentile(std::vector<int64_t> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
   }
-  consumer_func<Q, T>(queue, hist, thread_count, count);
-  for (int i = 0; i < thread_count; ++i) {
-    threads[i].join();
+  return sorted[std::min(sorted.size() - 1,
+                         static_cast<size_t>(p * sorted.size()))];
+}
+
+template <template <typename> class Q, size_t PAYLOAD_SIZE>
+void benchmarker(std::string_view name, size_t producer_count,
+                 size_t consumer_count, size_t msg_count) {
+  using T = Payload<PAYLOAD_SIZE>;
+  static_assert(is_queue<Q<T>, T>);
+
+  // Threads that share a core take turns rather than run in parallel: their
+  // numbers measure the scheduler as much as the queue
+  const bool shared_cores = producer_count + consumer_count > cpu_count();
+  if (shared_cores) {
+    fmt::print(stderr, "warning: {} {}x{}: {} threads for {} core(s), shared\n",
+               name, producer_count, consumer_count,
+               producer_count + consumer_count, cpu_count());
+  }
+
+  const uint32_t per_producer = msg_count / producer_count;
+  RunContext ctx(per_producer * producer_count);
+  Q<T> queue(ctx.total_msg);
+  std::vector<std::vector<int64_t>> latencies(consumer_count);
+  for (auto &l : latencies) {
+    l.reserve(ctx.total_msg);
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < producer_count; ++i) {
+    threads.emplace_back(&producer_func<Q<T>, T>, std::ref(queue),
+                         std::ref(ctx), i, i * per_producer, per_producer);
+  }
+  for (size_t i = 0; i < consumer_count; ++i) {
+    threads.emplace_back(&consumer_func<Q<T>, T>, std::ref(queue),
+                         std::ref(ctx), producer_count + i,
+                         std::ref(latencies[i]));
+  }
+  const auto t0 = std::chrono::steady_clock::now();
+  ctx.go.store(true, std::memory_order_release);
+  for (auto &t : threads) {
+    t.join();
   }
-  auto t1 = std::chrono::steady_clock::now();
-  fmt::print(
-      "takes: {} ms\n",
-      std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count());
-
-  for (int idx = 0; idx < count; ++idx) {
-    if (hist[idx] != thread_count) {
-      fmt::print("Unexpected result hist[{}] == {}, expect {}", idx, hist[idx],
-                 thread_count);
+  const auto t1 = std::chrono::steady_clock::now();
+
+  for (size_t idx = 0; idx < ctx.total_msg; ++idx) {
+    if (ctx.seen[idx] != 1) {
+      fmt::print(stderr, "{}: unexpected result seen[{}] == {}, expect 1\n",
+                 name, idx, ctx.seen[idx]);
       break;
     }
   }
+
+  std::vector<int64_t> merged;
+  merged.reserve(ctx.total_msg);
+  for (const auto &l : latencies) {
+    merged.insert(merged.end(), l.begin(), l.end());
+  }
+  std::sort(merged.begin(), merged.end());
+  const auto elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+  fmt::print("{},{},{},{},{},{:.3f},{:.0f},{},{},{},{:d}\n", name,
+             PAYLOAD_SIZE, producer_count, consumer_count, ctx.total_msg,
+             elapsed_ns / 1'000'000.0, ctx.total_msg * 1e9 / elapsed_ns,
+             percentile(merged, 0.5), percentile(merged, 0.99),
+             percentile(merged, 0.999), shared_cores);
+}
+
+template <template <typename> class Q, size_t PAYLOAD_SIZE>
+void sweep(std::string_view name, size_t max_threads, size_t msg_count) {
+  for (size_t producers = 1; producers <= max_threads; producers *= 2) {
+    for (size_t consumers = 1; consumers <= max_threads; consumers *= 2) {
+      benchmarker<Q, PAYLOAD_SIZE>(name, producers, consumers, msg_count);
+    }
+  }
 }
 
-int main() {
-  benchmarker<LinkedList::LockedQueue<int>, int>();
-  benchmarker<LinkedList::LockFreeQueue<int>, int>();
-  benchmarker<boost::lockfree::queue<int>, int>();
-  benchmarker<ThirdParty::MoodyCamelConcurrentQueue<int>, int>();
-  benchmarker<ThirdParty::MoodyCamelReaderWriterQueue<int>, int>();
-}
\ No newline at end of file
+template <template <typename> class Q>
+void sweep_payloads(std::string_view name, size_t max_threads,
+                    size_t msg_count) {
+  sweep<Q, 4>(name, max_threads, msg_count);
+  sweep<Q, 64>(name, max_threads, msg_count);
+  sweep<Q, 256>(name, max_threads, msg_count);
+}
+
+int main(int argc, char **argv) {
+  // Usage: driver [msg_count_per_run] [max_producers_and_consumers]
+  const size_t msg_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                    : 1'000'000;
+  const size_t max_threads =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+  fmt::print("queue,payload_bytes,producers,consumers,messages,elapsed_ms,"
+             "ops_per_sec,p50_ns,p99_ns,p999_ns,shared_cores\n");
+  sweep_payloads<LinkedList::LockedQueue>("LockedQueue", max_threads,
+                                          msg_count);
+  sweep_payloads<LinkedList::LockFreeQueue>("LockFreeQueue", max_threads,
+                                            msg_count);
+  sweep_payloads<BoostQueue>("boost::lockfree::queue", max_threads,
+                             msg_count);
+  sweep_payloads<ThirdParty::MoodyCamelConcurrentQueue>(
+      "moodycamel::ConcurrentQueue", max_threads, msg_count);
+  // Single-producer single-consumer only, so it is not part of the sweep
+  sweep_payloads<ThirdParty::MoodyCamelReaderWriterQueue>(
+      "moodycamel::BlockingReaderWriterCircularBuffer", 1, msg_count);
+}
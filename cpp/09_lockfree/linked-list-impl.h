@@ -1,69 +1,272 @@
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace PoC::LockFree::LinkedList {
+
+// Michael-Scott MPMC queue with hazard pointer reclamation.
+//
+// - Nodes are intrusive: the value lives in the node itself, so a push costs
+//   at most one allocation, and none once the node freelist is warm.
+// - Dequeued nodes are retired into a per-slot list and only recycled into the
+//   freelist once no hazard pointer refers to them, so a node is never reused
+//   while another thread may still be dereferencing it.
+// - The freelist is a Treiber stack whose head carries a 16-bit ABA tag in the
+//   unused upper bits of the pointer (x86-64/AArch64 user space is 48 bits).
+//   Nodes in it are type-stable: they are only freed by ~LockFreeQueue().
+// - Hazard slots are claimed per operation rather than per thread, so there
+//   is no thread registration and no thread_local lifetime to get wrong. A
+//   thread_local hint makes the claim an uncontended exchange in practice.
+//   There are max_slots (128) of them, so at most that many push()/pop()
+//   calls hold one at a time. More threads still work, but a call that finds
+//   every slot taken waits for one to be released, yielding between passes.
+//
+// Like boost::lockfree::queue, T must be trivially copyable: pop() copies the
+// value out of a node before it knows whether its CAS on head will win.
 template <typename T> class LockFreeQueue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "LockFreeQueue<T> requires a trivially copyable T");
+  static_assert(sizeof(void *) == 8, "tagged pointers assume 64-bit pointers");
+
 private:
+  static constexpr size_t cache_line_size = 64;
+  static constexpr size_t max_slots = 128;
+  static constexpr size_t hazards_per_slot = 2;
+  // Scanning is O(hazard count), so amortise it over at least as many retires
+  static constexpr size_t scan_threshold = 2 * max_slots * hazards_per_slot;
+
   struct Node {
-    std::shared_ptr<T> data;
-    std::atomic<std::shared_ptr<Node>> next;
-    Node() = default;
-    explicit Node(T value) : data(std::make_shared<T>(std::move(value))) {}
+    std::atomic<Node *> next = nullptr;
+    T value{};
+  };
+
+  struct alignas(cache_line_size) HazardSlot {
+    std::atomic<bool> busy = false;
+    std::atomic<Node *> hp[hazards_per_slot] = {};
+    // Only touched by whoever currently holds the slot
+    std::vector<Node *> retired;
+  };
+
+  // Releases the hazard slot on scope exit
+  class SlotGuard {
+  public:
+    HazardSlot *slot;
+    explicit SlotGuard(HazardSlot *s) : slot(s) {}
+    ~SlotGuard() {
+      for (auto &hp : slot->hp) {
+        hp.store(nullptr, std::memory_order_release);
+      }
+      slot->busy.store(false, std::memory_order_release);
+    }
+    SlotGuard(const SlotGuard &) = delete;
+    SlotGuard &operator=(const SlotGuard &) = delete;
   };
 
-  std::atomic<std::shared_ptr<Node>> head;
-  std::atomic<std::shared_ptr<Node>> tail;
+  static constexpr uint64_t ptr_mask = (uint64_t{1} << 48) - 1;
+
+  static uint64_t pack(Node *ptr, uint64_t tag) {
+    return (reinterpret_cast<uint64_t>(ptr) & ptr_mask) | (tag << 48);
+  }
+  static Node *unpack_ptr(uint64_t tagged) {
+    return reinterpret_cast<Node *>(tagged & ptr_mask);
+  }
+  static uint64_t unpack_tag(uint64_t tagged) { return tagged >> 48; }
+
+  alignas(cache_line_size) std::atomic<Node *> m_head;
+  alignas(cache_line_size) std::atomic<Node *> m_tail;
+  alignas(cache_line_size) std::atomic<uint64_t> m_free_list = 0;
+  std::array<HazardSlot, max_slots> m_slots;
+
+  // Slots are only held for one push()/pop(), so this always ends. After a
+  // full pass with every slot taken, yield: the holders may be preempted
+  // threads that need this core to finish and release theirs.
+  HazardSlot *acquire_slot() {
+    thread_local size_t hint = 0;
+    for (size_t n = 0;; ++n) {
+      const size_t i = (hint + n) % max_slots;
+      auto &slot = m_slots[i];
+      if (!slot.busy.load(std::memory_order_relaxed) &&
+          !slot.busy.exchange(true, std::memory_order_acquire)) {
+        hint = i;
+        return &slot;
+      }
+      if ((n + 1) % max_slots == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // Publishes src's current value in hp and returns it once it is confirmed
+  // that src still pointed to it after the publication became visible.
+  static Node *protect(std::atomic<Node *> &hp, const std::atomic<Node *> &src) {
+    Node *p = src.load(std::memory_order_relaxed);
+    while (true) {
+      hp.store(p, std::memory_order_seq_cst);
+      Node *q = src.load(std::memory_order_seq_cst);
+      if (p == q) {
+        return p;
+      }
+      p = q;
+    }
+  }
+
+  Node *allocate_node(const T &value) {
+    uint64_t top = m_free_list.load(std::memory_order_acquire);
+    while (unpack_ptr(top) != nullptr) {
+      Node *node = unpack_ptr(top);
+      // node may be popped and reused concurrently, in which case this read is
+      // stale, but the tag guarantees the CAS below then fails
+      Node *next = node->next.load(std::memory_order_relaxed);
+      if (m_free_list.compare_exchange_weak(top,
+                                            pack(next, unpack_tag(top) + 1),
+                                            std::memory_order_acquire)) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->value = value;
+        return node;
+      }
+    }
+    auto node = new Node();
+    node->value = value;
+    return node;
+  }
+
+  void free_node(Node *node) {
+    uint64_t top = m_free_list.load(std::memory_order_relaxed);
+    do {
+      node->next.store(unpack_ptr(top), std::memory_order_relaxed);
+    } while (!m_free_list.compare_exchange_weak(
+        top, pack(node, unpack_tag(top) + 1), std::memory_order_release));
+  }
+
+  void retire(HazardSlot *slot, Node *node) {
+    slot->retired.push_back(node);
+    if (slot->retired.size() >= scan_threshold) {
+      scan(slot);
+    }
+  }
+
+  void scan(HazardSlot *slot) {
+    std::array<Node *, max_slots * hazards_per_slot> hazards;
+    size_t hazard_count = 0;
+    for (auto &s : m_slots) {
+      for (auto &hp : s.hp) {
+        Node *p = hp.load(std::memory_order_seq_cst);
+        if (p != nullptr) {
+          hazards[hazard_count++] = p;
+        }
+      }
+    }
+    std::sort(hazards.begin(), hazards.begin() + hazard_count);
+
+    auto &retired = slot->retired;
+    size_t kept = 0;
+    for (Node *node : retired) {
+      if (std::binary_search(hazards.begin(), hazards.begin() + hazard_count,
+                             node)) {
+        retired[kept++] = node;
+      } else {
+        free_node(node);
+      }
+    }
+    retired.resize(kept);
+  }
 
 public:
   LockFreeQueue(int dummy_int) {
-    auto dummy = std::make_shared<Node>();
-    head.store(dummy);
-    tail.store(dummy);
+    for (auto &slot : m_slots) {
+      slot.retired.reserve(scan_threshold);
+    }
+    auto dummy = new Node();
+    m_head.store(dummy);
+    m_tail.store(dummy);
+  }
+
+  LockFreeQueue(const LockFreeQueue &) = delete;
+  LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+  // Not thread-safe: no other thread may be using the queue any more
+  ~LockFreeQueue() {
+    Node *node = m_head.load();
+    while (node != nullptr) {
+      Node *next = node->next.load();
+      delete node;
+      node = next;
+    }
+    for (auto &slot : m_slots) {
+      for (Node *retired : slot.retired) {
+        delete retired;
+      }
+    }
+    node = unpack_ptr(m_free_list.load());
+    while (node != nullptr) {
+      Node *next = node->next.load();
+      delete node;
+      node = next;
+    }
   }
 
   void push(T const value) {
-    auto new_node = std::make_shared<Node>(value);
+    SlotGuard guard(acquire_slot());
+    Node *new_node = allocate_node(value);
+    auto &hp = guard.slot->hp[0];
 
     while (true) {
-      std::shared_ptr<Node> last = tail.load();
-      std::shared_ptr<Node> next = last->next.load();
-
-      if (last == tail.load()) {
-        if (next == nullptr) {
-          std::shared_ptr<Node> nullptr_node;
-          if (last->next.compare_exchange_weak(nullptr_node, new_node)) {
-            tail.compare_exchange_weak(last, new_node);
-            return;
-          }
-        } else {
-          tail.compare_exchange_weak(last, next);
-        }
+      Node *last = protect(hp, m_tail);
+      Node *next = last->next.load(std::memory_order_acquire);
+      if (last != m_tail.load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (next != nullptr) {
+        // tail is lagging behind, help the other producer swing it
+        m_tail.compare_exchange_weak(last, next, std::memory_order_release);
+        continue;
+      }
+      Node *expected = nullptr;
+      if (last->next.compare_exchange_weak(expected, new_node,
+                                           std::memory_order_release)) {
+        m_tail.compare_exchange_strong(last, new_node,
+                                       std::memory_order_release);
+        return;
       }
     }
   }
 
   bool pop(T &result) {
+    SlotGuard guard(acquire_slot());
+    auto &hp_first = guard.slot->hp[0];
+    auto &hp_next = guard.slot->hp[1];
+
     while (true) {
-      auto first = head.load();
-      auto last = tail.load();
-      auto next = first->next.load();
-
-      if (first == head.load()) {
-        if (first == last) {
-          if (!next) {
-            return false;
-          }
-          tail.compare_exchange_weak(last, next);
-        } else {
-          if (next) {
-            result = *(next->data);
-            if (head.compare_exchange_weak(first, next)) {
-              return true;
-            }
-          }
-        }
+      Node *first = protect(hp_first, m_head);
+      Node *last = m_tail.load(std::memory_order_acquire);
+      Node *next = first->next.load(std::memory_order_acquire);
+      hp_next.store(next, std::memory_order_seq_cst);
+      // If head hasn't moved, next can't have been retired yet, so hp_next
+      // now keeps it alive
+      if (first != m_head.load(std::memory_order_seq_cst)) {
+        continue;
+      }
+      if (next == nullptr) {
+        return false;
+      }
+      if (first == last) {
+        m_tail.compare_exchange_weak(last, next, std::memory_order_release);
+        continue;
+      }
+      T value = next->value;
+      if (m_head.compare_exchange_weak(first, next,
+                                       std::memory_order_acq_rel)) {
+        result = value;
+        hp_first.store(nullptr, std::memory_order_release);
+        retire(guard.slot, first);
+        return true;
       }
     }
   }
 };
-} // namespace PoC::LockFree::LinkedList
\ No newline at end of file
+} // namespace PoC::LockFree::LinkedList
@@ -0,0 +1,147 @@
+#ifndef POC_LOCKFREE_RINGBUFFER_SPSC_IMPL_H
+#define POC_LOCKFREE_RINGBUFFER_SPSC_IMPL_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace PoC::LockFree {
+
+// Single-producer single-consumer bounded ring buffer.
+//
+// - head (consumer-owned) and tail (producer-owned) live on separate cache
+//   lines, so the two threads don't false-share on every operation.
+// - Each side keeps a plain (non-atomic) cached copy of the other side's
+//   index and only reloads the shared atomic when the cached value says the
+//   queue is full/empty. In steady state this means zero cross-core traffic
+//   on the index of the other side.
+// - Indices grow monotonically and are masked into the buffer, so capacity is
+//   always rounded up to a power of two.
+// - enqueue_bulk()/dequeue_bulk() move up to N elements but publish them with
+//   a single release store.
+template <typename T> class RingBufferSPSC {
+private:
+  static constexpr size_t cache_line_size = 64;
+
+  struct alignas(cache_line_size) ConsumerSide {
+    std::atomic<size_t> head = 0;
+    size_t cached_tail = 0;
+  };
+
+  struct alignas(cache_line_size) ProducerSide {
+    std::atomic<size_t> tail = 0;
+    size_t cached_head = 0;
+  };
+
+  ConsumerSide m_consumer;
+  ProducerSide m_producer;
+
+  // Read-only after construction, shared by both sides
+  alignas(cache_line_size) const size_t m_capacity;
+  const size_t m_mask;
+  std::unique_ptr<T[]> m_buffer;
+
+  static size_t round_up_capacity(size_t capacity) {
+    if (capacity > (std::numeric_limits<size_t>::max() >> 1)) {
+      throw std::invalid_argument("capacity too large");
+    }
+    return std::bit_ceil(capacity < 2 ? size_t{2} : capacity);
+  }
+
+public:
+  explicit RingBufferSPSC(size_t capacity)
+      : m_capacity(round_up_capacity(capacity)), m_mask(m_capacity - 1),
+        m_buffer(new T[m_capacity]) {}
+
+  RingBufferSPSC(const RingBufferSPSC &) = delete;
+  RingBufferSPSC &operator=(const RingBufferSPSC &) = delete;
+
+  // ===== Producer side =====
+
+  template <typename U> bool enqueue(U &&value) {
+    const size_t tail = m_producer.tail.load(std::memory_order_relaxed);
+    if (tail - m_producer.cached_head == m_capacity) [[unlikely]] {
+      m_producer.cached_head =
+          m_consumer.head.load(std::memory_order_acquire);
+      if (tail - m_producer.cached_head == m_capacity) {
+        return false;
+      }
+    }
+    m_buffer[tail & m_mask] = std::forward<U>(value);
+    m_producer.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves up to count elements from [first, first + count) into the queue,
+  // returns the number of elements actually enqueued.
+  template <typename InputIt> size_t enqueue_bulk(InputIt first, size_t count) {
+    const size_t tail = m_producer.tail.load(std::memory_order_relaxed);
+    size_t free_slots = m_capacity - (tail - m_producer.cached_head);
+    if (free_slots < count) {
+      m_producer.cached_head =
+          m_consumer.head.load(std::memory_order_acquire);
+      free_slots = m_capacity - (tail - m_producer.cached_head);
+    }
+    const size_t n = count < free_slots ? count : free_slots;
+    for (size_t i = 0; i < n; ++i, ++first) {
+      m_buffer[(tail + i) & m_mask] = std::move(*first);
+    }
+    if (n > 0) {
+      m_producer.tail.store(tail + n, std::memory_order_release);
+    }
+    return n;
+  }
+
+  // ===== Consumer side =====
+
+  bool dequeue(T &result) {
+    const size_t head = m_consumer.head.load(std::memory_order_relaxed);
+    if (head == m_consumer.cached_tail) [[unlikely]] {
+      m_consumer.cached_tail = m_producer.tail.load(std::memory_order_acquire);
+      if (head == m_consumer.cached_tail) {
+        return false;
+      }
+    }
+    result = std::move(m_buffer[head & m_mask]);
+    m_consumer.head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves up to max_count elements into out, returns the number of elements
+  // actually dequeued.
+  template <typename OutputIt> size_t dequeue_bulk(OutputIt out, size_t max_count) {
+    const size_t head = m_consumer.head.load(std::memory_order_relaxed);
+    size_t available = m_consumer.cached_tail - head;
+    if (available < max_count) {
+      m_consumer.cached_tail = m_producer.tail.load(std::memory_order_acquire);
+      available = m_consumer.cached_tail - head;
+    }
+    const size_t n = max_count < available ? max_count : available;
+    for (size_t i = 0; i < n; ++i, ++out) {
+      *out = std::move(m_buffer[(head + i) & m_mask]);
+    }
+    if (n > 0) {
+      m_consumer.head.store(head + n, std::memory_order_release);
+    }
+    return n;
+  }
+
+  // ===== Either side =====
+
+  // Only a snapshot, may be stale by the time the caller reads it
+  size_t size_approx() const {
+    const size_t tail = m_producer.tail.load(std::memory_order_acquire);
+    const size_t head = m_consumer.head.load(std::memory_order_acquire);
+    return tail - head;
+  }
+
+  size_t capacity() const { return m_capacity; }
+};
+
+} // namespace PoC::LockFree
+
+#endif // POC_LOCKFREE_RINGBUFFER_SPSC_IMPL_H
@@ -1,25 +1,317 @@
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
-// TIP To <b>Run</b> code, press <shortcut actionId="Run"/> or
-// click the <icon src="AllIcons.Actions.Execute"/> icon in the gutter.
-int main() {
-    // TIP Press <shortcut actionId="RenameElement"/> when your caret is at the
-    // <b>lang</b> variable name to see how CLion can help you rename it.
-    auto lang = "C++";
-    std::cout << "Hello and welcome to " << lang << "!\n";
+#include <zmq.hpp>
 
-    for (int i = 1; i <= 5; i++) {
-        // TIP Press <shortcut actionId="Debug"/> to start debugging your code.
-        // We have set one <icon src="AllIcons.Debugger.Db_set_breakpoint"/>
-        // breakpoint for you, but you can always add more by pressing
-        // <shortcut actionId="ToggleLineBreakpoint"/>.
-        std::cout << "i = " << i << std::endl;
+#include "pushpull.h"
+#include "utils.h"
+
+// ZeroMQ topology benchmark: one producer and N consumers as threads of one
+// process, so that inproc:// can be measured next to tcp:// and ipc://.
+//
+// - pushpull: PUSH -> N PULL, records are load-balanced, delivered once
+// - pubsub:   PUB -> N SUB, every subscriber gets every record
+// - dealer:   N DEALER clients -> ROUTER echo server, records are split
+//             between the clients, latency is the round trip
+//
+// The producer side sends `records` records flat out, packed `batch` to a
+// frame, each record being `size` bytes. Every combination of the option
+// lists is run and printed as one CSV row.
+
+struct Options {
+    std::vector<std::string> patterns = {"pushpull", "pubsub", "dealer"};
+    std::vector<std::string> transports = {"tcp", "ipc", "inproc"};
+    std::vector<size_t> ioThreads = {1};
+    std::vector<size_t> hwms = {1000};
+    std::vector<size_t> sizes = {sizeof(Timestamp)};
+    std::vector<size_t> batches = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
+    std::vector<size_t> consumers = {1};
+    int64_t records = 1'000'000;
+};
+
+struct Setting {
+    std::string pattern;
+    std::string transport;
+    size_t ioThreads;
+    size_t hwm;
+    size_t size;
+    size_t batch;
+    size_t consumers;
+    int64_t records;
+
+    std::string endpoint() const {
+        if (transport == "tcp")
+            return "tcp://127.0.0.1:31416";
+        if (transport == "ipc")
+            return "ipc:///tmp/10_zeromq.ipc";
+        return "inproc://10_zeromq";
     }
 
-    return 0;
+    size_t frameBytes() const { return batch * size; }
+};
+
+// Consumers give up after a second without data: the rest was dropped (PUB,
+// ROUTER) or went to another PULL socket
+constexpr int idleTimeoutMs = 1000;
+// Frames a DEALER client keeps in flight
+constexpr int64_t dealerWindow = 64;
+
+struct ConsumerResult {
+    int64_t records = 0;
+    int64_t lastRecvNs = 0;
+};
+
+// PULL and SUB side. Stops once `delivered` reaches target, that counter is
+// shared by all PULL sockets and private to each SUB socket. Empty frames are
+// the publisher's warm-up and only mark the subscriber as connected.
+template<class RECORDER>
+ConsumerResult consume(zmq::socket_t &sock, RECORDER &recorder, const size_t recordSize,
+                       std::atomic<int64_t> &delivered, const int64_t target, std::atomic<size_t> &ready) {
+    ConsumerResult result;
+    bool connected = false;
+    zmq::message_t msg;
+    while (!ev_flag && delivered.load(std::memory_order_relaxed) < target) {
+        if (!sock.recv(msg, zmq::recv_flags::none))
+            break;
+        if (!connected) {
+            connected = true;
+            ready.fetch_add(1);
+        }
+        if (msg.size() == 0)
+            continue;
+        const auto n = static_cast<int64_t>(unpackFrame(msg, recordSize, recorder));
+        result.records += n;
+        result.lastRecvNs = nowNs();
+        delivered.fetch_add(n, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+// DEALER client, sends its quota of records and records each one's round trip
+template<class RECORDER>
+ConsumerResult requestReplies(zmq::socket_t &sock, BufferPool &pool, RECORDER &recorder, const Setting &s,
+                              const int64_t quota) {
+    ConsumerResult result;
+    int64_t sent = 0;
+    int64_t inFlight = 0;
+    zmq::message_t reply;
+    while (!ev_flag && result.records < quota) {
+        while (sent < quota && inFlight < dealerWindow) {
+            const size_t n = std::min<size_t>(s.batch, quota - sent);
+            auto msg = packFrame(pool, n, s.size);
+            sock.send(msg, zmq::send_flags::none);
+            sent += static_cast<int64_t>(n);
+            ++inFlight;
+        }
+        if (!sock.recv(reply, zmq::recv_flags::none))
+            break;
+        --inFlight;
+        result.records += static_cast<int64_t>(unpackFrame(reply, s.size, recorder));
+        result.lastRecvNs = nowNs();
+    }
+    return result;
+}
+
+void setHwm(zmq::socket_t &sock, const size_t hwm) {
+    sock.set(zmq::sockopt::sndhwm, static_cast<int>(hwm));
+    sock.set(zmq::sockopt::rcvhwm, static_cast<int>(hwm));
+}
+
+void run(const Setting &s) {
+    const std::string endpoint = s.endpoint();
+    PercentileTracker<int64_t> pt;
+    std::vector<ConsumerResult> results(s.consumers);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> ready = 0;
+    int64_t sent = 0;
+    int64_t expected = s.records;
+    int64_t t0 = 0;
+
+    // The pools outlive the context, whose destructor waits for zmq to drop
+    // every message still referencing them
+    BufferPool pool(poolSlotsFor(s.frameBytes()), s.frameBytes());
+    std::vector<std::unique_ptr<BufferPool>> clientPools;
+    {
+        zmq::context_t ctx(static_cast<int>(s.ioThreads));
+
+        if (s.pattern == "dealer") {
+            zmq::socket_t router(ctx, zmq::socket_type::router);
+            setHwm(router, s.hwm);
+            router.set(zmq::sockopt::rcvtimeo, idleTimeoutMs);
+            router.bind(endpoint);
+
+            t0 = nowNs();
+            for (size_t c = 0; c < s.consumers; ++c) {
+                const int64_t quota = s.records / s.consumers + (c == 0 ? s.records % s.consumers : 0);
+                auto &clientPool = clientPools.emplace_back(
+                    std::make_unique<BufferPool>(std::min<size_t>(poolSlotsFor(s.frameBytes()), 2 * dealerWindow),
+                                                 s.frameBytes()));
+                threads.emplace_back([&, c, quota, clientPool = clientPool.get()] {
+                    zmq::socket_t dealer(ctx, zmq::socket_type::dealer);
+                    setHwm(dealer, s.hwm);
+                    dealer.set(zmq::sockopt::rcvtimeo, idleTimeoutMs);
+                    dealer.connect(endpoint);
+                    auto recorder = pt.makeRecorder();
+                    results[c] = requestReplies(dealer, *clientPool, recorder, s, quota);
+                });
+            }
+            // Echo: [identity, payload] goes back as is, the payload is never copied
+            zmq::message_t identity, payload;
+            while (!ev_flag && sent < s.records) {
+                if (!router.recv(identity, zmq::recv_flags::none))
+                    break;
+                if (!router.recv(payload, zmq::recv_flags::none))
+                    break;
+                sent += static_cast<int64_t>(payload.size() / s.size);
+                router.send(identity, zmq::send_flags::sndmore);
+                router.send(payload, zmq::send_flags::none);
+            }
+            for (auto &t : threads)
+                t.join();
+        } else {
+            const bool pubsub = s.pattern == "pubsub";
+            zmq::socket_t producer(ctx, pubsub ? zmq::socket_type::pub : zmq::socket_type::push);
+            setHwm(producer, s.hwm);
+            producer.bind(endpoint);
+
+            std::vector<std::atomic<int64_t>> delivered(pubsub ? s.consumers : 1);
+            expected = pubsub ? s.records * static_cast<int64_t>(s.consumers) : s.records;
+            for (size_t c = 0; c < s.consumers; ++c) {
+                threads.emplace_back([&, c] {
+                    zmq::socket_t consumer(ctx, pubsub ? zmq::socket_type::sub : zmq::socket_type::pull);
+                    setHwm(consumer, s.hwm);
+                    consumer.set(zmq::sockopt::rcvtimeo, idleTimeoutMs);
+                    if (pubsub)
+                        consumer.set(zmq::sockopt::subscribe, "");
+                    consumer.connect(endpoint);
+                    auto recorder = pt.makeRecorder();
+                    results[c] = consume(consumer, recorder, s.size, delivered[pubsub ? c : 0], s.records, ready);
+                });
+            }
+            // PUB drops everything sent before a subscriber has joined
+            while (pubsub && !ev_flag && ready.load() < s.consumers) {
+                producer.send(zmq::message_t(), zmq::send_flags::none);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            t0 = nowNs();
+            sent = pushRecords(producer, pool, s.batch, s.size, s.records, false);
+            for (auto &t : threads)
+                t.join();
+        }
+    }
+
+    int64_t delivered = 0;
+    int64_t lastRecvNs = t0;
+    for (const auto &r : results) {
+        delivered += r.records;
+        lastRecvNs = std::max(lastRecvNs, r.lastRecvNs);
+    }
+    std::print("{},{},{},{},{},{},{},{},{},{},", s.pattern, s.transport, s.ioThreads, s.hwm, s.size, s.batch,
+               s.consumers, sent, delivered, expected);
+    const auto hist = pt.snapshot();
+    if (hist.count() == 0 || lastRecvNs == t0) {
+        std::print(",,,,,,\n");
+        return;
+    }
+    const double recordsPerSec = 1e9 * static_cast<double>(delivered) / static_cast<double>(lastRecvNs - t0);
+    const auto p = hist.getPercentiles({50.0, 99.0, 99.9});
+    std::print("{:.0f},{:.1f},{},{},{},{}\n", recordsPerSec, recordsPerSec * s.size / (1024 * 1024), p[0], p[1],
+               p[2], hist.max());
+}
+
+std::vector<std::string> splitList(std::string_view list) {
+    std::vector<std::string> items;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        items.emplace_back(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    }
+    return items;
+}
+
+std::vector<size_t> parseNumbers(std::string_view list) {
+    std::vector<size_t> numbers;
+    for (const auto &item : splitList(list))
+        numbers.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    return numbers;
 }
 
-// TIP See CLion help at <a
-// href="https://www.jetbrains.com/help/clion/">jetbrains.com/help/clion/</a>.
-//  Also, you can try interactive lessons for CLion by selecting
-//  'Help | Learn IDE Features' from the main menu.
\ No newline at end of file
+bool validate(const Options &o) {
+    const auto in = [](const std::string &v, std::initializer_list<std::string_view> allowed) {
+        return std::ranges::find(allowed, v) != allowed.end();
+    };
+    return !o.patterns.empty() && !o.transports.empty() && !o.ioThreads.empty() && !o.hwms.empty() &&
+           !o.sizes.empty() && !o.batches.empty() && !o.consumers.empty() && o.records > 0 &&
+           std::ranges::all_of(o.patterns, [&](const auto &p) { return in(p, {"pushpull", "pubsub", "dealer"}); }) &&
+           std::ranges::all_of(o.transports, [&](const auto &t) { return in(t, {"tcp", "ipc", "inproc"}); }) &&
+           std::ranges::all_of(o.ioThreads, [](size_t n) { return n >= 1; }) &&
+           std::ranges::all_of(o.sizes, [](size_t n) { return n >= sizeof(Timestamp); }) &&
+           std::ranges::all_of(o.batches, [](size_t n) { return n >= 1 && n <= maxBatch; }) &&
+           std::ranges::all_of(o.consumers, [](size_t n) { return n >= 1 && n <= 16; });
+}
+
+void usage(const char *argv0) {
+    std::print(stderr,
+               "usage: {} [--pattern=pushpull,pubsub,dealer] [--transport=tcp,ipc,inproc] [--io-threads=1,...]\n"
+               "       [--hwm=1000,...] [--size=8,...] [--batch=1,...,{}] [--consumers=1,...,16] [--records=N]\n"
+               "Every option takes a comma-separated list, every combination is run.\n"
+               "hwm 0 is unlimited, size is the record size in bytes (>= {}), batch the records per frame.\n",
+               argv0, maxBatch, sizeof(Timestamp));
+}
+
+int main(int argc, char *argv[]) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const auto eq = arg.find('=');
+        const auto key = arg.substr(0, eq);
+        const auto value = eq == std::string_view::npos ? std::string_view() : arg.substr(eq + 1);
+        if (key == "--pattern")
+            o.patterns = splitList(value);
+        else if (key == "--transport")
+            o.transports = splitList(value);
+        else if (key == "--io-threads")
+            o.ioThreads = parseNumbers(value);
+        else if (key == "--hwm")
+            o.hwms = parseNumbers(value);
+        else if (key == "--size")
+            o.sizes = parseNumbers(value);
+        else if (key == "--batch")
+            o.batches = parseNumbers(value);
+        else if (key == "--consumers")
+            o.consumers = parseNumbers(value);
+        else if (key == "--records")
+            o.records = std::strtoll(std::string(value).c_str(), nullptr, 10);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!validate(o)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, signal_handler);
+    std::print("pattern,transport,io_threads,hwm,record_size,batch,consumers,sent,delivered,expected,"
+               "records_per_sec,mb_per_sec,p50_ns,p99_ns,p999_ns,max_ns\n");
+    for (const auto &pattern : o.patterns)
+        for (const auto &transport : o.transports)
+            for (const size_t ioThreads : o.ioThreads)
+                for (const size_t hwm : o.hwms)
+                    for (const size_t size : o.sizes)
+                        for (const size_t batch : o.batches)
+                            for (const size_t consumers : o.consumers) {
+                                if (ev_flag)
+                                    return 0;
+                                run({pattern, transport, ioThreads, hwm, size, batch, consumers, o.records});
+                            }
+    return 0;
+}
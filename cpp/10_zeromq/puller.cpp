@@ -1,56 +1,65 @@
 #include <csignal>
+#include <cstdlib>
 #include <iostream>
 #include <print>
+#include <string>
 #include <thread>
 
 #include <zmq.hpp>
 #include <zmq_addon.hpp>
 
+#include "pushpull.h"
 #include "utils.h"
 
-std::mutex mtx;
-
-void PrintStats(PercentileTracker<int64_t> &pt) {
-    double msg_per_sec = 0.0;
-    const std::vector threeSigmas = {68.0, 95.0, 99.7};
-    std::vector<int64_t> stats;
-    auto t0 = chrono::duration_cast<chrono::microseconds>(
-        chrono::high_resolution_clock::now().time_since_epoch()).count();
+void PrintStats(const PercentileTracker<int64_t> &pt) {
+    const std::vector percents = {50.0, 99.0, 99.9, 99.99};
+    auto prev = pt.snapshot();
+    auto prevTs = chrono::steady_clock::now();
     while (!ev_flag) {
-        std::this_thread::sleep_for(std::chrono::seconds(3)); {
-            pt.refreshStats();
-            stats = pt.getPercentiles(threeSigmas);
+        std::this_thread::sleep_for(std::chrono::seconds(3));
+        const auto total = pt.snapshot();
+        const auto now = chrono::steady_clock::now();
+        auto interval = total;
+        interval -= prev;
+
+        const auto elapsedUs = chrono::duration_cast<chrono::microseconds>(now - prevTs).count();
+        const auto msgPerSec = 1'000'000 * static_cast<int64_t>(interval.count()) / elapsedUs;
+        if (interval.count() == 0) {
+            std::print("MsgCount: {}k (0/s)\n", total.count() / 1000);
+        } else {
+            const auto stats = interval.getPercentiles(percents);
+            std::print(
+                "MsgCount: {}k ({}/s); Latency (ns) of the last {} msgs: 50th: {}, 99th: {}, 99.9th: {}, "
+                "99.99th: {}; max since start: {}\n",
+                total.count() / 1000, msgPerSec, interval.count(), stats[0], stats[1], stats[2], stats[3],
+                total.max());
         }
-        const auto now = chrono::duration_cast<chrono::microseconds>(
-        chrono::high_resolution_clock::now().time_since_epoch()).count();
-        msg_per_sec = 1'000'000 * msgCount / (now - t0);
-        std::print(
-            "MsgCount: {}k ({}/s); Percentiles (us) from {} samples at {} sampling rate: 68th: {}, 95th: {}, 99.7th: {}\n",
-            msgCount / 1000, msg_per_sec, pt.sampleCount(),
-            pt.sample_ratio, stats[0], stats[1], stats[2]);
+        prev = total;
+        prevTs = now;
     }
 }
 
-int main() {
+// usage: puller [endpoint] [record size], endpoint defaults to
+// tcp://127.0.0.1:31415, record size (same as the pusher's) to 8 bytes.
+// Frames may carry any number of records, whatever the pusher's batch size.
+int main(int argc, char *argv[]) {
+    const std::string endpoint = argc > 1 ? argv[1] : "tcp://127.0.0.1:31415";
+    const size_t recordSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : sizeof(Timestamp);
+    if (recordSize < sizeof(Timestamp) || endpoint.starts_with("inproc://")) {
+        std::print(stderr, "usage: {} [tcp://...|ipc://...] [record size >= {}]\n", argv[0], sizeof(Timestamp));
+        return 1;
+    }
+
     signal(SIGINT, signal_handler);
-    auto pt = PercentileTracker<int64_t>(1000, 0.01, mtx);
+    PercentileTracker<int64_t> pt;
+    auto recorder = pt.makeRecorder();
     zmq::context_t ctx;
     zmq::socket_t sock(ctx, zmq::socket_type::pull);
-    sock.connect("tcp://127.0.0.1:31415");
+    sock.connect(endpoint);
 
-    std::thread thStats(PrintStats, std::ref(pt));
-    while (!ev_flag) {
-        zmq::message_t msg;
-        if (!sock.recv(msg, zmq::recv_flags::none))
-            break;
-        ++msgCount;
-        auto pusherTs = *msg.data<int64_t>();
-        const int64_t pullerTs = chrono::duration_cast<chrono::microseconds>(
-            chrono::high_resolution_clock::now().time_since_epoch()).count();
-
-        pt.addSample(pullerTs - pusherTs);
-    }
+    std::thread thStats(PrintStats, std::cref(pt));
+    pullRecords(sock, recorder, recordSize, -1);
     thStats.join();
     return 0;
 
-}
\ No newline at end of file
+}
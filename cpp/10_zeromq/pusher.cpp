@@ -1,10 +1,13 @@
 #include <chrono>
 #include <csignal>
+#include <cstdlib>
 #include <print>
+#include <string>
 #include <thread>
 
 #include <zmq_addon.hpp>
 
+#include "pushpull.h"
 #include "utils.h"
 
 void PrintStats() {
@@ -14,29 +17,31 @@ void PrintStats() {
     }
 }
 
-int main() {
+// usage: pusher [endpoint] [batch] [record size]
+// endpoint defaults to tcp://127.0.0.1:31415, batch (records per frame,
+// 1..maxBatch) to 1, record size to 8 bytes. inproc:// only works within a
+// process, see 10_zeromq.
+int main(int argc, char *argv[]) {
+    const std::string endpoint = argc > 1 ? argv[1] : "tcp://127.0.0.1:31415";
+    const size_t batch = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+    const size_t recordSize = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : sizeof(Timestamp);
+    if (batch < 1 || batch > maxBatch || recordSize < sizeof(Timestamp) || endpoint.starts_with("inproc://")) {
+        std::print(stderr, "usage: {} [tcp://...|ipc://...] [batch 1..{}] [record size >= {}]\n", argv[0], maxBatch,
+                   sizeof(Timestamp));
+        return 1;
+    }
+
     signal(SIGINT, signal_handler);
+    BufferPool pool(poolSlotsFor(batch * recordSize), batch * recordSize);
     zmq::context_t ctx;
     zmq::socket_t sock(ctx, zmq::socket_type::push);
     // I want to set high water mark to 1 to avoid buffering
     sock.set(zmq::sockopt::sndhwm, 1000);
-    sock.bind("tcp://127.0.0.1:31415");
-    int64_t t0 = chrono::duration_cast<chrono::microseconds>(
-               chrono::high_resolution_clock::now().time_since_epoch()).count();
+    sock.bind(endpoint);
+    std::print("Pushing {} record(s) of {} bytes per frame to {}\n", batch, recordSize, endpoint);
     std::thread thStats(PrintStats);
-    while (!ev_flag) {
-        const auto delayUs = 1;
-        const int64_t pusherTs = chrono::duration_cast<chrono::microseconds>(
-            chrono::high_resolution_clock::now().time_since_epoch()).count();
-        zmq::message_t msg(&pusherTs, sizeof(pusherTs));
-        sock.send(msg, zmq::send_flags::none);
-        ++msgCount;
-
-
-        if (msgCount % 1000 == 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-    }
+    pushRecords(sock, pool, batch, recordSize, -1, true);
+    thStats.join();
     std::print("Pusher exited gracefully\n");
     return 0;
 }
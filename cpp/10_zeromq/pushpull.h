@@ -0,0 +1,146 @@
+#ifndef PUSH_PULL_H
+#define PUSH_PULL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <zmq.hpp>
+
+#include "utils.h"
+
+// A frame carries 1..maxBatch records of recordSize bytes. Each record starts
+// with the sender's steady_clock timestamp (ns) taken when it was packed, the
+// rest is padding. steady_clock is CLOCK_MONOTONIC, which is system-wide, so
+// timestamps can be compared across processes on one host.
+using Timestamp = int64_t;
+
+constexpr size_t maxBatch = 1024;
+// Frames that can be in flight at once, comfortably above the default
+// 1000-frame send + receive high water marks, unless that would take more
+// than 64 MB of buffers
+inline size_t poolSlotsFor(const size_t frameBytes) {
+    return std::clamp<size_t>((64 << 20) / frameBytes, 16, 4096);
+}
+
+inline int64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Fixed set of frame buffers handed to zmq without copying them
+// (zmq_msg_init_data() with release() as free function).
+//
+// zmq calls release() from whichever thread drops the last reference to the
+// message: its I/O thread for tcp:// and ipc://, the receiving thread for
+// inproc://. A slot is therefore just an atomic in-use flag: the (single)
+// sending thread scans for a free one, release() clears it. When all slots
+// are in flight the sender waits, which is the back-pressure we want anyway.
+//
+// zmq_msg_init_data() still mallocs a small refcount header per message, the
+// payload itself is never copied or allocated.
+class BufferPool {
+    struct alignas(64) Slot {
+        std::atomic<bool> inUse{false};
+        char *data = nullptr;
+    };
+
+public:
+    BufferPool(const size_t slotCount, const size_t frameBytes)
+        : slotCount(slotCount), slots(std::make_unique<Slot[]>(slotCount)),
+          storage(std::make_unique<char[]>(slotCount * frameBytes)) {
+        for (size_t i = 0; i < slotCount; ++i)
+            slots[i].data = &storage[i * frameBytes];
+    }
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // Returns the buffer and the hint to pass to zmq along with release()
+    std::pair<char *, void *> acquire() {
+        while (true) {
+            for (size_t n = 0; n < slotCount; ++n) {
+                Slot &slot = slots[next];
+                next = next + 1 == slotCount ? 0 : next + 1;
+                // acquire pairs with release(), zmq is done with the buffer
+                if (!slot.inUse.load(std::memory_order_acquire)) {
+                    slot.inUse.store(true, std::memory_order_relaxed);
+                    return {slot.data, &slot};
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    static void release(void * /*data*/, void *hint) {
+        static_cast<Slot *>(hint)->inUse.store(false, std::memory_order_release);
+    }
+
+private:
+    size_t slotCount;
+    size_t next = 0;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<char[]> storage;
+};
+
+// Packs n timestamped records into a pooled frame, recordSize >= sizeof(Timestamp)
+inline zmq::message_t packFrame(BufferPool &pool, const size_t n, const size_t recordSize) {
+    auto [data, hint] = pool.acquire();
+    for (size_t i = 0; i < n; ++i) {
+        const Timestamp ts = nowNs();
+        std::memcpy(data + i * recordSize, &ts, sizeof(ts));
+    }
+    return {data, n * recordSize, BufferPool::release, hint};
+}
+
+// Records the latency of every record in the frame, read in place, and
+// returns how many there were
+template<class RECORDER>
+size_t unpackFrame(const zmq::message_t &msg, const size_t recordSize, RECORDER &recorder) {
+    const int64_t now = nowNs();
+    const auto *data = msg.data<const char>();
+    const size_t n = msg.size() / recordSize;
+    for (size_t i = 0; i < n; ++i) {
+        Timestamp ts;
+        std::memcpy(&ts, data + i * recordSize, sizeof(ts));
+        recorder.record(now - ts);
+    }
+    return n;
+}
+
+// Sends `records` records (until ev_flag if < 0), packed `batch` to a frame.
+// paced sleeps 1 ms every 1000 records, ~1M records/s at most.
+inline int64_t pushRecords(zmq::socket_t &sock, BufferPool &pool, const size_t batch, const size_t recordSize,
+                           const int64_t records, const bool paced) {
+    int64_t sent = 0;
+    while (!ev_flag && (records < 0 || sent < records)) {
+        const size_t n = records < 0 ? batch : std::min<size_t>(batch, records - sent);
+        auto msg = packFrame(pool, n, recordSize);
+        sock.send(msg, zmq::send_flags::none);
+
+        if (paced && (sent + static_cast<int64_t>(n)) / 1000 != sent / 1000)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        sent += static_cast<int64_t>(n);
+        msgCount = sent;
+    }
+    return sent;
+}
+
+// Receives until `records` records (until ev_flag if < 0) or a receive
+// timeout, recording each record's latency
+template<class RECORDER>
+int64_t pullRecords(zmq::socket_t &sock, RECORDER &recorder, const size_t recordSize, const int64_t records) {
+    int64_t received = 0;
+    zmq::message_t msg;
+    while (!ev_flag && (records < 0 || received < records)) {
+        if (!sock.recv(msg, zmq::recv_flags::none))
+            break;
+        received += static_cast<int64_t>(unpackFrame(msg, recordSize, recorder));
+    }
+    return received;
+}
+
+#endif //PUSH_PULL_H
@@ -2,11 +2,17 @@
 #define PERCENTILE_TRACKER_H
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <ranges>
-#include <deque>
-#include <mutex>
-#include <random>
 #include <stdexcept>
+#include <vector>
+
+#include "../common/latency_histogram.h"
 
 
 namespace chrono = std::chrono;
@@ -22,59 +28,117 @@ inline void signal_handler(int signal) {
     ev_flag = true;
 }
 
-template<class T>
-class PercentileTracker {
-    static_assert(std::is_arithmetic_v<T>, "T must be a numeric type");
+// Plain, single-threaded histogram, what PercentileTracker::snapshot() returns.
+// Two snapshots can be subtracted to get the distribution of an interval.
+template<class T, unsigned SUB_BUCKET_BITS = 7>
+class Histogram {
+    using Buckets = LogLinearBuckets<SUB_BUCKET_BITS>;
 
 public:
-    double sample_ratio;
-    explicit PercentileTracker(const size_t sample_size, const double sample_ratio, std::mutex& mtx) : sample_size(sample_size),
-        refreshStatsCalled(false), sample_ratio(sample_ratio), mtx(mtx) {
-        rnd = std::uniform_real_distribution<>(0, 1);
-    }
+    Histogram() : counts(Buckets::count) {}
 
-    bool addSample(T num) {
-        if (rnd(re) > sample_ratio)
-            return false; {
-            std::lock_guard lck(mtx);
-            samples.push_back(num);
-            if (samples.size() > sample_size) {
-                samples.pop_front();
-            }
-        }
-        return true;
+    void add(size_t idx, uint64_t n) {
+        counts[idx] += n;
+        total += n;
     }
 
-    void refreshStats() {
-        std::sort(samples.begin(), samples.end());
-        refreshStatsCalled = true;
+    void updateMax(uint64_t value) { maxValue = std::max(maxValue, value); }
+
+    // Removes the samples of an earlier snapshot. The max can't be taken back,
+    // so it stays the cumulative max.
+    Histogram &operator-=(const Histogram &earlier) {
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] -= earlier.counts[i];
+        total -= earlier.total;
+        return *this;
     }
 
-    std::vector<T> getPercentiles(const std::vector<double> &percents) {
-        if (samples.empty())
-            throw std::invalid_argument("samples.empty()");
-        refreshStats();
-
-        auto percentiles = percents | views::transform([&](auto p) {
-            int index = p
-            / 100.0 * samples.size() - 1;
-            if (index < 0)
-                index = 0;
-            return samples[index];
+    std::vector<T> getPercentiles(const std::vector<double> &percents) const {
+        if (total == 0)
+            throw std::invalid_argument("total == 0");
+
+        return percents | views::transform([&](auto p) {
+            return static_cast<T>(valueAtPercentile(p));
         }) | ranges::to<std::vector>();
-        return percentiles;
     }
 
-    auto sampleCount() { return samples.size(); }
+    uint64_t count() const { return total; }
+    T max() const { return static_cast<T>(maxValue); }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t maxValue = 0;
+
+    uint64_t valueAtPercentile(double p) const {
+        return Buckets::value_at_percentile(counts, total, maxValue, p);
+    }
+};
+
+// Wait-free, fixed-memory latency recorder.
+//
+// Every recording thread claims its own shard of buckets once, via
+// makeRecorder(), and is then its only writer: record() is a relaxed
+// load/store pair on a counter no other thread writes, no lock, no RMW, no
+// allocation. Readers merge all shards into a Histogram with snapshot(),
+// which never blocks the recorders.
+template<class T, unsigned SUB_BUCKET_BITS = 7, size_t MAX_THREADS = 16>
+class PercentileTracker {
+    static_assert(std::is_integral_v<T>, "T must be an integral type");
+    using Buckets = LogLinearBuckets<SUB_BUCKET_BITS>;
+
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, Buckets::count> counts{};
+        std::atomic<uint64_t> maxValue{0};
+    };
+
+public:
+    class Recorder {
+    public:
+        explicit Recorder(Shard &shard) : shard(&shard) {}
+
+        // Negative values (clock going backwards) are counted as 0
+        void record(T value) {
+            const auto v = static_cast<uint64_t>(std::max<T>(value, 0));
+            auto &counter = shard->counts[Buckets::index_of(v)];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (v > shard->maxValue.load(std::memory_order_relaxed))
+                shard->maxValue.store(v, std::memory_order_relaxed);
+        }
+
+    private:
+        Shard *shard;
+    };
+
+    PercentileTracker() : shards(std::make_unique<std::array<Shard, MAX_THREADS>>()) {}
+
+    // One per recording thread, not to be shared between threads
+    Recorder makeRecorder() {
+        const size_t idx = claimedShards.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= MAX_THREADS)
+            throw std::length_error("PercentileTracker: more than MAX_THREADS recorders");
+        return Recorder((*shards)[idx]);
+    }
+
+    // Counts recorded so far, each bucket is read atomically but the shards
+    // aren't frozen, so samples recorded during the merge may or may not make it
+    Histogram<T, SUB_BUCKET_BITS> snapshot() const {
+        Histogram<T, SUB_BUCKET_BITS> merged;
+        const size_t claimed = std::min(claimedShards.load(std::memory_order_relaxed), MAX_THREADS);
+        for (size_t s = 0; s < claimed; ++s) {
+            const Shard &shard = (*shards)[s];
+            for (size_t i = 0; i < Buckets::count; ++i) {
+                if (const auto n = shard.counts[i].load(std::memory_order_relaxed))
+                    merged.add(i, n);
+            }
+            merged.updateMax(shard.maxValue.load(std::memory_order_relaxed));
+        }
+        return merged;
+    }
 
 private:
-    // Need to use std::deque to have std::sort() operational
-    std::deque<T> samples;
-    size_t sample_size;
-    bool refreshStatsCalled;
-    std::uniform_real_distribution<double> rnd;
-    std::default_random_engine re;
-    std::mutex &mtx;
+    std::unique_ptr<std::array<Shard, MAX_THREADS>> shards;
+    std::atomic<size_t> claimedShards{0};
 };
 
 #endif //PERCENTILE_TRACKER_H
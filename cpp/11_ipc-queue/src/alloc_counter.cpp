@@ -0,0 +1,33 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete. The array and nothrow forms
+// forward to these in libstdc++, so every heap allocation is counted.
+
+namespace {
+thread_local uint64_t allocation_count = 0;
+}
+
+uint64_t thread_allocation_count() { return allocation_count; }
+
+void *operator new(const std::size_t size) {
+    ++allocation_count;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(const std::size_t size, const std::align_val_t alignment) {
+    ++allocation_count;
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void *ptr = std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
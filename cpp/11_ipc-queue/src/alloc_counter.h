@@ -0,0 +1,11 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+
+// Number of operator new calls made by the calling thread so far, counted by
+// the global operator new replacement in alloc_counter.cpp. Per thread, so the
+// async logger's worker thread doesn't show up in the message loop's count.
+uint64_t thread_allocation_count();
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,55 @@
+#ifndef BOOST_MESSAGE_QUEUE_H
+#define BOOST_MESSAGE_QUEUE_H
+
+#include <boost/interprocess/ipc/message_queue.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// boost::interprocess::message_queue behind the same send()/receive()
+// interface as ShmSpscRing. Every send/receive takes the queue's
+// interprocess mutex, and waits on its condition variable when full/empty.
+class BoostMessageQueue {
+public:
+    // Producer side: (re)creates the queue, removing any left over by an
+    // earlier run first. A unique_ptr as message_queue can't be moved.
+    static std::unique_ptr<BoostMessageQueue> create(const std::string &name, const size_t slot_count,
+                                                     const size_t slot_size) {
+        remove(name);
+        return std::unique_ptr<BoostMessageQueue>(
+                new BoostMessageQueue(boost::interprocess::create_only, name, slot_count, slot_size));
+    }
+
+    // Fan-in producers: the first one creates the queue, the others share it,
+    // message_queue is multi-producer safe
+    BoostMessageQueue(boost::interprocess::open_or_create_t, const std::string &name, const size_t slot_count,
+                      const size_t slot_size)
+        : mq(boost::interprocess::open_or_create, name.c_str(), slot_count, slot_size) {}
+
+    // Consumer side: attaches to a queue created by the producer
+    BoostMessageQueue(boost::interprocess::open_only_t, const std::string &name)
+        : mq(boost::interprocess::open_only, name.c_str()) {}
+
+    static void remove(const std::string &name) { boost::interprocess::message_queue::remove(name.c_str()); }
+
+    size_t max_msg_size() const { return mq.get_max_msg_size(); }
+
+    void send(const void *data, const size_t size) { mq.send(data, size, 0); }
+
+    void receive(void *buf, const size_t buf_size, size_t &recvd_size) {
+        unsigned int priority;
+        boost::interprocess::message_queue::size_type size;
+        mq.receive(buf, buf_size, size, priority);
+        recvd_size = size;
+    }
+
+private:
+    BoostMessageQueue(boost::interprocess::create_only_t, const std::string &name, const size_t slot_count,
+                      const size_t slot_size)
+        : mq(boost::interprocess::create_only, name.c_str(), slot_count, slot_size) {}
+
+    boost::interprocess::message_queue mq;
+};
+
+#endif // BOOST_MESSAGE_QUEUE_H
@@ -1,52 +1,208 @@
+#include "../../common/latency_histogram.h"
+#include "alloc_counter.h"
+#include "boost_message_queue.h"
+#include "shm_spsc_ring.h"
 #include "test_payload.pb.h"
+#include "topology.h"
 
-#include <boost/interprocess/ipc/message_queue.hpp>
+#include <cxxopts.hpp>
 #include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 using namespace boost::interprocess;
 
-int main() {
-    constexpr std::string queue_name = "my_message_queue";
+// Per-producer statistics. Latency and the message count are per interval,
+// the sequence checks are cumulative.
+struct StreamStats {
+    LatencyHistogram<> latencies;
+    uint64_t received = 0;
+    uint64_t gaps = 0;         // times a sequence number was skipped
+    uint64_t missing = 0;      // messages skipped in total
+    uint64_t out_of_order = 0; // older or repeated sequence numbers
+    uint32_t next_seq_num = 0;
+    bool seen = false;
+
+    void on_message(const uint32_t seq_num, const int64_t latency_ns) {
+        latencies.record(latency_ns);
+        ++received;
+        if (seen && seq_num != next_seq_num) {
+            if (seq_num > next_seq_num) {
+                ++gaps;
+                missing += seq_num - next_seq_num;
+            } else {
+                // Both transports keep each producer's order, so going back
+                // means the producer restarted (or resent): counted once, then
+                // followed from the new number, or everything after it would
+                // count as out of order too
+                ++out_of_order;
+            }
+        }
+        seen = true;
+        next_seq_num = seq_num + 1;
+    }
+
+    void reset_interval() {
+        latencies.reset();
+        received = 0;
+    }
+};
+
+// Receives forever, logging msgs/sec, allocations per message, the latency
+// distribution and sequence gaps of every 5 s interval, in aggregate and per
+// producer. zero_alloc receives into one reused buffer and parses only the
+// received bytes in place, otherwise every message gets a fresh std::string.
+template<class Queue>
+void consume(Queue &mq, const bool zero_alloc, const std::shared_ptr<spdlog::logger> &lgr) {
+    uint32_t msg_received_count = 0;
+    size_t recvd_size;
+    constexpr long intervals_us = 5'000'000;
+    long long prev_unix_time_us = 0;
+    uint64_t prev_allocs = thread_allocation_count();
+    boost_ipc_payload::TestMessage msg;
+    LatencyHistogram<> latencies;
+    // Indexed by producer id, only grows when a new producer shows up
+    std::vector<StreamStats> streams;
+    std::vector<char> reused_buffer(mq.max_msg_size());
+    while (true) {
+        ++msg_received_count;
+        if (zero_alloc) {
+            mq.receive(reused_buffer.data(), reused_buffer.size(), recvd_size);
+            msg.ParseFromArray(reused_buffer.data(), static_cast<int>(recvd_size));
+        } else {
+            std::string buffer;
+            buffer.resize(mq.max_msg_size());
+            mq.receive(buffer.data(), buffer.size(), recvd_size);
+            buffer.resize(recvd_size);
+            msg.ParseFromString(buffer);
+        }
+        const auto recv_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count();
+        const int64_t latency_ns = recv_time_ns - msg.send_time_ns();
+        latencies.record(latency_ns);
+        if (msg.producer_id() >= streams.size())
+            streams.resize(msg.producer_id() + 1);
+        streams[msg.producer_id()].on_message(msg.seq_num(), latency_ns);
+
+        auto now = std::chrono::system_clock::now();
+        auto unix_time_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        if (unix_time_us - prev_unix_time_us > intervals_us) {
+            const uint64_t allocs = thread_allocation_count();
+            const long long interval_s = (unix_time_us - prev_unix_time_us) / 1'000'000;
+            uint64_t gaps = 0, missing = 0, out_of_order = 0;
+            for (const auto &stream : streams) {
+                gaps += stream.gaps;
+                missing += stream.missing;
+                out_of_order += stream.out_of_order;
+            }
+            lgr->info("{} msg/sec received, {:.3f} allocs/msg. Latency(ns) p50={}, p99={}, p99.9={}, max={}. "
+                      "gaps={}, missing={}, out_of_order={}. Latest msg: recvd_size={}, producer_id={}, seq_num={}, "
+                      "timestamp_us={}",
+                      msg_received_count / interval_s, static_cast<double>(allocs - prev_allocs) / msg_received_count,
+                      latencies.value_at_percentile(50.0), latencies.value_at_percentile(99.0),
+                      latencies.value_at_percentile(99.9), latencies.max(), gaps, missing, out_of_order, recvd_size,
+                      msg.producer_id(), msg.seq_num(), msg.unix_time_us());
+            for (size_t id = 0; streams.size() > 1 && id < streams.size(); ++id) {
+                auto &stream = streams[id];
+                if (stream.seen)
+                    lgr->info("  producer {}: {} msg/sec, Latency(ns) p50={}, p99={}, max={}. gaps={}, missing={}, "
+                              "out_of_order={}",
+                              id, stream.received / interval_s, stream.latencies.value_at_percentile(50.0),
+                              stream.latencies.value_at_percentile(99.0), stream.latencies.max(), stream.gaps,
+                              stream.missing, stream.out_of_order);
+                stream.reset_interval();
+            }
+            prev_unix_time_us = unix_time_us;
+            msg_received_count = 0;
+            latencies.reset();
+            prev_allocs = thread_allocation_count();
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    cxxopts::Options options("consumer", "Receives TestMessages from the producer(s) over an IPC queue");
+    options.add_options()
+        ("t,transport", "boost (boost::interprocess::message_queue) or shm (lock-free SPSC ring), same as the producer",
+         cxxopts::value<std::string>()->default_value("shm"))
+        ("q,queue", "Queue name", cxxopts::value<std::string>()->default_value("my_message_queue"))
+        ("w,wait", "shm only, what to do while the ring is empty: spin, yield or block",
+         cxxopts::value<std::string>()->default_value("block"))
+        ("z,zero-alloc", "Reuse the receive buffer, no allocation per message")
+        ("topology", "one-to-one, fan-in (N producers -> 1 consumer) or fan-out (1 producer -> N consumers)",
+         cxxopts::value<std::string>()->default_value("one-to-one"))
+        ("producers", "fan-in only, number of producers", cxxopts::value<size_t>()->default_value("1"))
+        ("id", "fan-out only, this consumer's id in 0..N-1", cxxopts::value<size_t>()->default_value("0"))
+        ("h,help", "Print usage");
+    const auto args = options.parse(argc, argv);
+    if (args.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    const auto transport = args["transport"].as<std::string>();
+    const auto queue_name = args["queue"].as<std::string>();
+    const bool zero_alloc = args.count("zero-alloc") > 0;
+    const auto producers = args["producers"].as<size_t>();
+    const auto consumer_id = args["id"].as<size_t>();
+
     spdlog::init_thread_pool(64, 1);
     auto stdout_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
     auto lgr = std::make_shared<spdlog::async_logger>("", stdout_sink, spdlog::thread_pool(),
                                                       spdlog::async_overflow_policy::overrun_oldest);
     lgr->set_pattern("%Y-%m-%dT%T.%f|%5t|%8l| %v");
-    lgr->info("consumer started");
+    lgr->info("consumer {} started, transport={}, topology={}, zero_alloc={}", consumer_id, transport,
+              args["topology"].as<std::string>(), zero_alloc);
+
+    // The queues this consumer reads from, removed on exit
+    std::vector<std::string> names;
+    const auto remove_queues = [&] {
+        for (const auto &name : names) {
+            BoostMessageQueue::remove(name);
+            ShmSpscRing::remove(name);
+        }
+    };
     try {
-        message_queue mq(open_only, queue_name.c_str());
-
-        unsigned int priority;
-        uint32_t msg_received_count = 0;
-        message_queue::size_type recvd_size;
-        constexpr long intervals_us = 5'000'000;
-        long long prev_unix_time_us = 0;
-        boost_ipc_payload::TestMessage msg;
-        while (true) {
-            ++msg_received_count;
-            std::string buffer;
-            buffer.resize(1024);
-            mq.receive(buffer.data(), buffer.size(), recvd_size, priority);
-            auto now = std::chrono::system_clock::now();
-            auto unix_time_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
-            msg.ParseFromString(buffer);
-            if (unix_time_us - prev_unix_time_us > intervals_us) {
-                auto latency_us = unix_time_us - msg.unix_time_us();
-                lgr->info("{} msg/sec received. Latest msg: recvd_size={}, seq_num={}, timestamp_us={}, latency(us)={}",
-                          msg_received_count / ((unix_time_us - prev_unix_time_us) / 1'000'000), recvd_size,
-                          msg.seq_num(), msg.unix_time_us(), latency_us);
-                prev_unix_time_us = unix_time_us;
-                msg_received_count = 0;
+        const auto topology = parse_topology(args["topology"].as<std::string>());
+        if (topology == Topology::fan_in && transport == "shm") {
+            for (size_t p = 0; p < producers; ++p)
+                names.push_back(stream_name(queue_name, topology, p, consumer_id));
+        } else if (topology == Topology::fan_in) {
+            // boost fan-in producers share one multi-producer queue
+            names.push_back(queue_name);
+        } else {
+            names.push_back(stream_name(queue_name, topology, 0, consumer_id));
+        }
+
+        if (transport == "boost") {
+            BoostMessageQueue mq(open_only, names.front());
+            consume(mq, zero_alloc, lgr);
+        } else if (transport == "shm") {
+            const auto policy = parse_wait_policy(args["wait"].as<std::string>());
+            if (names.size() == 1) {
+                auto mq = ShmSpscRing::open(names.front(), policy);
+                consume(mq, zero_alloc, lgr);
+            } else {
+                ShmSpscRingSet mq(policy);
+                for (const auto &name : names)
+                    mq.add(ShmSpscRing::open(name, policy));
+                consume(mq, zero_alloc, lgr);
             }
+        } else {
+            std::cout << options.help() << std::endl;
+            return 1;
         }
-    } catch (interprocess_exception &ex) {
-        message_queue::remove(queue_name.c_str());
+    } catch (std::exception &ex) {
+        remove_queues();
         lgr->error("Error: {}", ex.what());
         return 1;
     }
-    message_queue::remove(queue_name.c_str());
+    remove_queues();
     return 0;
 }
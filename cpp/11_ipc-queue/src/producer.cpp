@@ -1,53 +1,169 @@
+#include "alloc_counter.h"
+#include "boost_message_queue.h"
+#include "shm_spsc_ring.h"
 #include "test_payload.pb.h"
+#include "topology.h"
 
-#include <boost/interprocess/ipc/message_queue.hpp>
+#include <cxxopts.hpp>
 #include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace boost::interprocess;
 
-int main() {
+// Sends forever, as fast as the queue takes it, or at msgs_per_sec.
+// zero_alloc reuses one TestMessage and serializes it into a preallocated
+// buffer, otherwise every message gets a fresh TestMessage and std::string.
+template<class Queue>
+void produce(Queue &mq, const uint32_t producer_id, const uint64_t msgs_per_sec, const bool zero_alloc,
+             const std::shared_ptr<spdlog::logger> &lgr) {
+    uint32_t seq_num = 0;
+    long long prev_unix_time_us = 0;
+    constexpr long intervals_us = 5'000'000;
+    uint32_t prev_seq_num = 0;
+    uint64_t prev_allocs = thread_allocation_count();
+    const auto start = std::chrono::steady_clock::now();
+    boost_ipc_payload::TestMessage reused_msg;
+    std::vector<char> buf(mq.max_msg_size());
+
+    while (true) {
+        if (msgs_per_sec > 0) {
+            const auto due = start + std::chrono::nanoseconds(seq_num * 1'000'000'000ULL / msgs_per_sec);
+            while (std::chrono::steady_clock::now() < due) {
+            }
+        }
+        auto now = std::chrono::system_clock::now();
+        // use long long, not long, Windows uses long long, Linux use long
+        const long long unix_time_us =
+                std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        const auto fill = [&](boost_ipc_payload::TestMessage &msg) {
+            msg.set_unix_time_us(unix_time_us);
+            msg.set_seq_num(seq_num);
+            msg.set_is_active(seq_num % 2 == 0);
+            msg.set_producer_id(producer_id);
+            msg.set_send_time_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+        };
+        if (zero_alloc) {
+            fill(reused_msg);
+            const auto size = reused_msg.ByteSizeLong();
+            if (size > buf.size() || !reused_msg.SerializeToArray(buf.data(), static_cast<int>(size)))
+                throw std::length_error("TestMessage larger than the queue's max message size");
+            mq.send(buf.data(), size);
+        } else {
+            boost_ipc_payload::TestMessage msg;
+            fill(msg);
+            const auto serialized = msg.SerializeAsString();
+            mq.send(serialized.data(), serialized.size());
+        }
+        ++seq_num;
+
+        if (unix_time_us - prev_unix_time_us > intervals_us) {
+            const uint64_t allocs = thread_allocation_count();
+            lgr->info("{} msg/sec sent, {:.3f} allocs/msg. Latest msg: seq_num={}, timestamp_us={}",
+                      (seq_num - prev_seq_num) / ((unix_time_us - prev_unix_time_us) / 1'000'000),
+                      static_cast<double>(allocs - prev_allocs) / (seq_num - prev_seq_num), seq_num - 1,
+                      unix_time_us);
+            prev_seq_num = seq_num;
+            prev_unix_time_us = unix_time_us;
+            prev_allocs = thread_allocation_count();
+        }
+    }
+}
+
+// make_queue(consumer_id) creates the queue to consumer_id
+template<class Queue, class MakeQueue>
+void produce_to(const Topology topology, const size_t consumers, MakeQueue make_queue, const uint32_t producer_id,
+                const uint64_t msgs_per_sec, const bool zero_alloc, const std::shared_ptr<spdlog::logger> &lgr) {
+    if (topology == Topology::fan_out) {
+        FanOut<Queue> mq;
+        for (size_t c = 0; c < consumers; ++c)
+            mq.add(make_queue(c));
+        produce(mq, producer_id, msgs_per_sec, zero_alloc, lgr);
+    } else {
+        auto mq = make_queue(0);
+        produce(*mq, producer_id, msgs_per_sec, zero_alloc, lgr);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    cxxopts::Options options("producer", "Sends TestMessages to the consumer over an IPC queue");
+    options.add_options()
+        ("t,transport", "boost (boost::interprocess::message_queue) or shm (lock-free SPSC ring)",
+         cxxopts::value<std::string>()->default_value("shm"))
+        ("q,queue", "Queue name", cxxopts::value<std::string>()->default_value("my_message_queue"))
+        ("slots", "Queue capacity in messages (shm rounds up to a power of two)",
+         cxxopts::value<size_t>()->default_value("4096"))
+        ("slot-size", "Max message size in bytes", cxxopts::value<size_t>()->default_value("256"))
+        ("w,wait", "shm only, what to do while the ring is full: spin, yield or block",
+         cxxopts::value<std::string>()->default_value("block"))
+        ("r,rate", "Messages per second, 0 for as fast as possible",
+         cxxopts::value<uint64_t>()->default_value("0"))
+        ("z,zero-alloc", "Reuse the message and serialization buffer, no allocation per message")
+        ("topology", "one-to-one, fan-in (N producers -> 1 consumer) or fan-out (1 producer -> N consumers)",
+         cxxopts::value<std::string>()->default_value("one-to-one"))
+        ("id", "fan-in only, this producer's id in 0..N-1", cxxopts::value<uint32_t>()->default_value("0"))
+        ("consumers", "fan-out only, number of consumers", cxxopts::value<size_t>()->default_value("1"))
+        ("h,help", "Print usage");
+    const auto args = options.parse(argc, argv);
+    if (args.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    const auto transport = args["transport"].as<std::string>();
+    const auto queue_name = args["queue"].as<std::string>();
+    const auto slots = args["slots"].as<size_t>();
+    const auto slot_size = args["slot-size"].as<size_t>();
+    const auto rate = args["rate"].as<uint64_t>();
+    const bool zero_alloc = args.count("zero-alloc") > 0;
+    const auto producer_id = args["id"].as<uint32_t>();
+    const auto consumers = args["consumers"].as<size_t>();
+
     spdlog::init_thread_pool(64, 1);
     auto stdout_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
     auto lgr = std::make_shared<spdlog::async_logger>("", stdout_sink, spdlog::thread_pool(),
                                                       spdlog::async_overflow_policy::overrun_oldest);
     lgr->set_pattern("%Y-%m-%dT%T.%f|%5t|%8l| %v");
-    lgr->info("consumer started");
+    lgr->info("producer {} started, transport={}, topology={}, slots={}, slot_size={}, zero_alloc={}", producer_id,
+              transport, args["topology"].as<std::string>(), slots, slot_size, zero_alloc);
 
     try {
-        // Erase previous message queue
-        message_queue::remove("my_message_queue");
-        uint32_t seq_num = 0;
-        // Create a message_queue.
-        message_queue mq(create_only, "my_message_queue", 100, 128);
-
-        long long prev_unix_time_us = 0;
-        constexpr long intervals_us = 5'000'000;
-        uint32_t prev_seq_num = 0;
-
-        while (true) {
-            boost_ipc_payload::TestMessage msg;
-            auto now = std::chrono::system_clock::now();
-            // use long long, not long, Windows uses long long, Linux use long
-            const long long unix_time_us =
-                    std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
-            msg.set_unix_time_us(unix_time_us);
-            msg.set_seq_num(seq_num++);
-            msg.set_is_active(seq_num % 2 == 0);
-            auto buf = msg.SerializeAsString();
-            mq.send(buf.data(), buf.size(), 0);
-            if (unix_time_us - prev_unix_time_us > intervals_us) {
-                lgr->info("{} msg/sec sent. Latest msg: seq_num={}, timestamp_us={}",
-                          (seq_num - prev_seq_num) / ((unix_time_us - prev_unix_time_us) / 1'000'000), msg.seq_num(),
-                          msg.unix_time_us());
-                prev_seq_num = seq_num;
-                prev_unix_time_us = unix_time_us;
-            }
+        const auto topology = parse_topology(args["topology"].as<std::string>());
+        if (transport == "boost") {
+            produce_to<BoostMessageQueue>(
+                    topology, consumers,
+                    [&](const size_t consumer_id) {
+                        // boost fan-in producers share one multi-producer queue
+                        return topology == Topology::fan_in
+                                       ? std::make_unique<BoostMessageQueue>(open_or_create, queue_name, slots,
+                                                                             slot_size)
+                                       : BoostMessageQueue::create(
+                                                 stream_name(queue_name, topology, 0, consumer_id), slots, slot_size);
+                    },
+                    producer_id, rate, zero_alloc, lgr);
+        } else if (transport == "shm") {
+            const auto policy = parse_wait_policy(args["wait"].as<std::string>());
+            produce_to<ShmSpscRing>(
+                    topology, consumers,
+                    [&](const size_t consumer_id) {
+                        return std::make_unique<ShmSpscRing>(ShmSpscRing::create(
+                                stream_name(queue_name, topology, producer_id, consumer_id), slots, slot_size,
+                                policy));
+                    },
+                    producer_id, rate, zero_alloc, lgr);
+        } else {
+            std::cout << options.help() << std::endl;
+            return 1;
         }
-    } catch (interprocess_exception &ex) {
+    } catch (std::exception &ex) {
         std::cout << ex.what() << std::endl;
         return 1;
     }
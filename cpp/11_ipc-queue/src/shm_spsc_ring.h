@@ -0,0 +1,334 @@
+#ifndef SHM_SPSC_RING_H
+#define SHM_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// What a side of the ring does while the ring is empty (consumer) or full
+// (producer)
+enum class WaitPolicy {
+    spin,  // burn the core, lowest latency
+    yield, // sched_yield() between polls
+    block, // spin for a while, then sleep on a futex until the other side signals
+};
+
+inline WaitPolicy parse_wait_policy(const std::string &name) {
+    if (name == "spin")
+        return WaitPolicy::spin;
+    if (name == "yield")
+        return WaitPolicy::yield;
+    if (name == "block")
+        return WaitPolicy::block;
+    throw std::invalid_argument("unknown wait policy: " + name);
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Single-producer single-consumer ring of variable-length messages in POSIX
+// shared memory (shm_open + mmap), for one producer and one consumer process.
+//
+// Each slot holds a 4-byte length and up to slot_size bytes of payload. The
+// producer-written tail and the consumer-written head live on separate cache
+// lines, and each side keeps a process-local copy of the other side's index
+// so that it only touches the shared one when the ring looks full/empty.
+//
+// send()/receive() never take a lock. With WaitPolicy::block the waiting side
+// parks on a shared (non-private) futex, and the other side only issues the
+// wake-up syscall when it sees the sleeping flag set.
+class ShmSpscRing {
+    static constexpr uint64_t magic = 0x5348'4d52'494e'4731; // "SHMRING1"
+    static constexpr size_t cache_line = 64;
+    static constexpr uint32_t spins_before_sleep = 1024;
+    static constexpr long sleep_timeout_ns = 100'000'000;
+
+    struct alignas(cache_line) Header {
+        uint64_t magic;
+        uint64_t slot_count;
+        uint64_t slot_stride;
+        std::atomic<bool> ready;
+
+        // Consumer-written
+        alignas(cache_line) std::atomic<uint64_t> head;
+        std::atomic<uint32_t> consumer_sleeping;
+        std::atomic<uint32_t> space_signal; // futex the producer sleeps on
+
+        // Producer-written
+        alignas(cache_line) std::atomic<uint64_t> tail;
+        std::atomic<uint32_t> producer_sleeping;
+        std::atomic<uint32_t> data_signal; // futex the consumer sleeps on
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "shared-memory atomics must be lock-free to be address-free");
+
+public:
+    // Producer side: (re)creates the shared-memory object
+    static ShmSpscRing create(const std::string &name, size_t slot_count, size_t slot_size, WaitPolicy policy) {
+        slot_count = std::bit_ceil(slot_count);
+        const size_t slot_stride = (sizeof(uint32_t) + slot_size + cache_line - 1) / cache_line * cache_line;
+        const size_t bytes = sizeof(Header) + slot_count * slot_stride;
+
+        remove(name);
+        const int fd = shm_open(shm_path(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+            throw_errno("shm_open(" + name + ")");
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            throw_errno("ftruncate(" + name + ")");
+        }
+        void *mem = map(fd, bytes, name);
+
+        auto *header = new (mem) Header{};
+        header->magic = magic;
+        header->slot_count = slot_count;
+        header->slot_stride = slot_stride;
+        header->ready.store(true, std::memory_order_release);
+        return ShmSpscRing(mem, bytes, policy);
+    }
+
+    // Consumer side: attaches to a ring created by the producer
+    static ShmSpscRing open(const std::string &name, WaitPolicy policy) {
+        const int fd = shm_open(shm_path(name).c_str(), O_RDWR, 0600);
+        if (fd < 0)
+            throw_errno("shm_open(" + name + ")");
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close(fd);
+            throw std::runtime_error("shm object " + name + " is not a ring");
+        }
+        const auto bytes = static_cast<size_t>(st.st_size);
+        void *mem = map(fd, bytes, name);
+
+        const auto *header = static_cast<const Header *>(mem);
+        if (!header->ready.load(std::memory_order_acquire) || header->magic != magic) {
+            munmap(mem, bytes);
+            throw std::runtime_error("shm object " + name + " is not a ring");
+        }
+        return ShmSpscRing(mem, bytes, policy);
+    }
+
+    static void remove(const std::string &name) { shm_unlink(shm_path(name).c_str()); }
+
+    ShmSpscRing(ShmSpscRing &&other) noexcept
+        : header(std::exchange(other.header, nullptr)), slots(other.slots), mapped_bytes(other.mapped_bytes),
+          mask(other.mask), stride(other.stride), policy(other.policy), cached_head(other.cached_head),
+          cached_tail(other.cached_tail) {}
+    ShmSpscRing(const ShmSpscRing &) = delete;
+    ShmSpscRing &operator=(const ShmSpscRing &) = delete;
+    ShmSpscRing &operator=(ShmSpscRing &&) = delete;
+
+    ~ShmSpscRing() {
+        if (header)
+            munmap(header, mapped_bytes);
+    }
+
+    size_t max_msg_size() const { return stride - sizeof(uint32_t); }
+    size_t capacity() const { return mask + 1; }
+
+    bool try_send(const void *data, const size_t size) {
+        if (size > max_msg_size())
+            throw std::length_error("message larger than the ring's slot size");
+        const uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        if (tail - cached_head == capacity()) {
+            cached_head = header->head.load(std::memory_order_acquire);
+            if (tail - cached_head == capacity())
+                return false;
+        }
+        char *slot = slot_at(tail);
+        const auto len = static_cast<uint32_t>(size);
+        std::memcpy(slot, &len, sizeof(len));
+        std::memcpy(slot + sizeof(len), data, size);
+        header->tail.store(tail + 1, std::memory_order_release);
+        if (policy == WaitPolicy::block)
+            wake_if_sleeping(header->consumer_sleeping, header->data_signal);
+        return true;
+    }
+
+    // Waits according to the policy while the ring is full
+    void send(const void *data, const size_t size) {
+        uint32_t spins = 0;
+        while (!try_send(data, size))
+            wait(spins, header->producer_sleeping, header->space_signal, [this] {
+                return header->tail.load(std::memory_order_relaxed) - header->head.load(std::memory_order_acquire) <
+                       capacity();
+            });
+    }
+
+    // Copies the oldest message into buf, whose size must be at least
+    // max_msg_size()
+    bool try_receive(void *buf, const size_t buf_size, size_t &recvd_size) {
+        const uint64_t head = header->head.load(std::memory_order_relaxed);
+        if (head == cached_tail) {
+            cached_tail = header->tail.load(std::memory_order_acquire);
+            if (head == cached_tail)
+                return false;
+        }
+        const char *slot = slot_at(head);
+        uint32_t len;
+        std::memcpy(&len, slot, sizeof(len));
+        if (len > buf_size)
+            throw std::length_error("receive buffer smaller than the message");
+        std::memcpy(buf, slot + sizeof(len), len);
+        recvd_size = len;
+        header->head.store(head + 1, std::memory_order_release);
+        if (policy == WaitPolicy::block)
+            wake_if_sleeping(header->producer_sleeping, header->space_signal);
+        return true;
+    }
+
+    // Waits according to the policy while the ring is empty
+    void receive(void *buf, const size_t buf_size, size_t &recvd_size) {
+        uint32_t spins = 0;
+        while (!try_receive(buf, buf_size, recvd_size))
+            wait(spins, header->consumer_sleeping, header->data_signal, [this] {
+                return header->tail.load(std::memory_order_acquire) != header->head.load(std::memory_order_relaxed);
+            });
+    }
+
+private:
+    Header *header;
+    char *slots;
+    size_t mapped_bytes;
+    uint64_t mask;
+    uint64_t stride;
+    WaitPolicy policy;
+    uint64_t cached_head = 0; // producer's copy
+    uint64_t cached_tail = 0; // consumer's copy
+
+    ShmSpscRing(void *mem, const size_t bytes, const WaitPolicy policy)
+        : header(static_cast<Header *>(mem)), slots(static_cast<char *>(mem) + sizeof(Header)), mapped_bytes(bytes),
+          mask(header->slot_count - 1), stride(header->slot_stride), policy(policy),
+          cached_head(header->head.load(std::memory_order_acquire)),
+          cached_tail(header->tail.load(std::memory_order_acquire)) {}
+
+    static std::string shm_path(const std::string &name) { return name.starts_with('/') ? name : "/" + name; }
+
+    [[noreturn]] static void throw_errno(const std::string &what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static void *map(const int fd, const size_t bytes, const std::string &name) {
+        void *mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mem == MAP_FAILED)
+            throw_errno("mmap(" + name + ")");
+        return mem;
+    }
+
+    char *slot_at(const uint64_t idx) const { return slots + (idx & mask) * stride; }
+
+    // Dekker-style handshake with wait(): the index store above and the flag
+    // load below are separated by a full fence, so either this side sees the
+    // flag or the sleeper sees the new index before going to sleep
+    static void wake_if_sleeping(std::atomic<uint32_t> &sleeping, std::atomic<uint32_t> &signal) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) [[unlikely]] {
+            signal.fetch_add(1, std::memory_order_release);
+            syscall(SYS_futex, &signal, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+        }
+    }
+
+    template<class READY>
+    void wait(uint32_t &spins, std::atomic<uint32_t> &sleeping, std::atomic<uint32_t> &signal, READY ready) {
+        switch (policy) {
+        case WaitPolicy::spin:
+            cpu_relax();
+            return;
+        case WaitPolicy::yield:
+            std::this_thread::yield();
+            return;
+        case WaitPolicy::block:
+            if (spins < spins_before_sleep) {
+                ++spins;
+                cpu_relax();
+                return;
+            }
+            sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const uint32_t seen = signal.load(std::memory_order_acquire);
+            if (!ready()) {
+                // Not FUTEX_WAIT_PRIVATE (what std::atomic::wait uses): the
+                // waker is another process. The timeout is only a safety net.
+                constexpr timespec timeout{0, sleep_timeout_ns};
+                syscall(SYS_futex, &signal, FUTEX_WAIT, seen, &timeout, nullptr, 0);
+            }
+            sleeping.store(0, std::memory_order_relaxed);
+            return;
+        }
+    }
+};
+
+// Consumer side of several rings, one per producer: receive() takes the next
+// message from whichever ring has one, round-robin so that no producer
+// starves. The futex handshake is per ring, so with WaitPolicy::block an idle
+// consumer yields between polls instead of sleeping (a full producer still
+// sleeps on its own ring).
+class ShmSpscRingSet {
+public:
+    explicit ShmSpscRingSet(const WaitPolicy policy) : policy(policy) {}
+
+    void add(ShmSpscRing ring) { rings.push_back(std::move(ring)); }
+
+    size_t max_msg_size() const {
+        size_t size = SIZE_MAX;
+        for (const auto &ring : rings)
+            size = std::min(size, ring.max_msg_size());
+        return size;
+    }
+
+    bool try_receive(void *buf, const size_t buf_size, size_t &recvd_size) {
+        for (size_t n = 0; n < rings.size(); ++n) {
+            ShmSpscRing &ring = rings[next];
+            next = next + 1 == rings.size() ? 0 : next + 1;
+            if (ring.try_receive(buf, buf_size, recvd_size))
+                return true;
+        }
+        return false;
+    }
+
+    void receive(void *buf, const size_t buf_size, size_t &recvd_size) {
+        while (!try_receive(buf, buf_size, recvd_size)) {
+            if (policy == WaitPolicy::spin)
+                cpu_relax();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    std::vector<ShmSpscRing> rings;
+    size_t next = 0;
+    WaitPolicy policy;
+};
+
+#endif // SHM_SPSC_RING_H
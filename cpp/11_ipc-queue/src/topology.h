@@ -0,0 +1,66 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// How producer and consumer processes are wired:
+// - one_to_one: one queue named <queue>
+// - fan_in:     N producers -> 1 consumer. The shm transport uses one SPSC ring
+//               per producer, <queue>.p<id>, polled by the consumer. Boost
+//               producers share the multi-producer queue <queue>.
+// - fan_out:    1 producer -> N consumers, each consumer gets every message on
+//               its own queue <queue>.c<id>
+enum class Topology { one_to_one, fan_in, fan_out };
+
+inline Topology parse_topology(const std::string &name) {
+    if (name == "one-to-one")
+        return Topology::one_to_one;
+    if (name == "fan-in")
+        return Topology::fan_in;
+    if (name == "fan-out")
+        return Topology::fan_out;
+    throw std::invalid_argument("unknown topology: " + name);
+}
+
+inline std::string stream_name(const std::string &queue, const Topology topology, const size_t producer_id,
+                               const size_t consumer_id) {
+    switch (topology) {
+    case Topology::fan_in:
+        return queue + ".p" + std::to_string(producer_id);
+    case Topology::fan_out:
+        return queue + ".c" + std::to_string(consumer_id);
+    default:
+        return queue;
+    }
+}
+
+// Producer side of fan-out: every message is sent to each consumer's queue in
+// turn. A full queue holds back the others, no consumer is ever skipped.
+template<class Queue>
+class FanOut {
+public:
+    void add(std::unique_ptr<Queue> queue) { queues.push_back(std::move(queue)); }
+
+    size_t max_msg_size() const {
+        size_t size = SIZE_MAX;
+        for (const auto &queue : queues)
+            size = std::min(size, queue->max_msg_size());
+        return size;
+    }
+
+    void send(const void *data, const size_t size) {
+        for (const auto &queue : queues)
+            queue->send(data, size);
+    }
+
+private:
+    std::vector<std::unique_ptr<Queue>> queues;
+};
+
+#endif // TOPOLOGY_H
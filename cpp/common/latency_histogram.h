@@ -0,0 +1,89 @@
+#ifndef COMMON_LATENCY_HISTOGRAM_H
+#define COMMON_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Latency histograms shared by the benchmarks of 06, 10 and 11, included by
+// relative path as each of them is its own CMake project.
+
+// HdrHistogram-style log-linear bucketing: values below 2^SUB_BUCKET_BITS get
+// a bucket each, every power-of-two range above that is split into
+// 2^(SUB_BUCKET_BITS - 1) linear buckets, so a percentile is reported with
+// < 1 / 2^(SUB_BUCKET_BITS - 1) relative error (< 1.6% with 7 bits).
+template<unsigned SUB_BUCKET_BITS = 7>
+struct LogLinearBuckets {
+    static constexpr unsigned half_bits = SUB_BUCKET_BITS - 1;
+    static constexpr uint64_t half_count = uint64_t{1} << half_bits;
+    static constexpr unsigned max_shift = 64 - SUB_BUCKET_BITS + 1;
+    static constexpr size_t count = max_shift * half_count + 2 * half_count;
+
+    static size_t index_of(const uint64_t value) {
+        const unsigned msb = 63 - std::countl_zero(value | 1);
+        const unsigned shift = msb < SUB_BUCKET_BITS ? 0 : msb - SUB_BUCKET_BITS + 1;
+        return shift * half_count + (value >> shift);
+    }
+
+    // Highest value that is counted in bucket idx
+    static uint64_t highest_value_at(const size_t idx) {
+        const unsigned shift = idx < 2 * half_count ? 0 : static_cast<unsigned>(idx / half_count) - 1;
+        const uint64_t sub = idx - shift * half_count;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    // percentile in [0, 100] of count buckets holding total samples, never
+    // more than the exact max_value
+    template<class Counts>
+    static uint64_t value_at_percentile(const Counts &counts, const uint64_t total, const uint64_t max_value,
+                                        const double percentile) {
+        if (total == 0)
+            return 0;
+        const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * total + 0.5));
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < count; ++i) {
+            cumulative += counts[i];
+            if (cumulative >= target)
+                return std::min(highest_value_at(i), max_value);
+        }
+        return max_value;
+    }
+};
+
+// Fixed memory and O(1) record(). Not thread-safe, meant to be owned by the
+// single thread that records.
+template<unsigned SUB_BUCKET_BITS = 7>
+class LatencyHistogram {
+    using Buckets = LogLinearBuckets<SUB_BUCKET_BITS>;
+
+    std::array<uint64_t, Buckets::count> counts{};
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+
+public:
+    // Negative values (clock going backwards) are counted as 0
+    void record(const int64_t value) {
+        const auto v = static_cast<uint64_t>(std::max<int64_t>(value, 0));
+        ++counts[Buckets::index_of(v)];
+        ++total;
+        max_value = std::max(max_value, v);
+    }
+
+    // percentile in [0, 100]
+    uint64_t value_at_percentile(const double percentile) const {
+        return Buckets::value_at_percentile(counts, total, max_value, percentile);
+    }
+
+    uint64_t max() const { return max_value; }
+    uint64_t count() const { return total; }
+
+    void reset() {
+        counts.fill(0);
+        total = 0;
+        max_value = 0;
+    }
+};
+
+#endif // COMMON_LATENCY_HISTOGRAM_H